@@ -0,0 +1,314 @@
+// per limb cost of the library against the matching gmp call, for the BIGINT_IMPL_TYPE this
+// is built with, one executable per limb type: bench_uint8_t ... bench_uint64_t
+//
+//   bench_uint64_t [--json] [--out=file] [--filter=op] [--max-bits=n] [--threads=n]
+//
+// --threads hands products above BIGINT_PARALLEL_THRESHOLD to bigint::set_threads,
+// gmp stays single threaded
+// --json writes the Google Benchmark layout, so its compare tools read the files as they are
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmp.h>
+
+#include "bigint.h"
+
+#define STRINGIFY_(x) #x
+#define STRINGIFY(x) STRINGIFY_(x)
+
+std::mt19937_64 mt64(0);
+volatile uint64_t sink;
+
+struct options{
+    bool json = false;
+    const char* out = nullptr;
+    const char* filter = nullptr;
+    size_t max_bits = (size_t)1 << 21;
+    size_t threads = 1;
+} opt;
+
+struct result{
+    std::string op;
+    size_t bits;
+    size_t limbs;
+    size_t iterations;
+    double ns;
+};
+std::vector<result> results;
+
+// best of five runs, in nanoseconds per call, and the calls per run
+template<typename F>
+std::pair<double, size_t> time_ns(F&& f){
+    using clock = std::chrono::steady_clock;
+    size_t reps = 1;
+    for(;;){
+        auto start = clock::now();
+        for(size_t i=0; i<reps; i++) f();
+        if(clock::now() - start > std::chrono::milliseconds(20)) break;
+        reps *= 2;
+    }
+    double best = 1e300;
+    for(int run=0; run<5; run++){
+        auto start = clock::now();
+        for(size_t i=0; i<reps; i++) f();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        best = std::min(best, elapsed.count() / reps);
+    }
+    return { best, reps };
+}
+
+// times f as op unless --filter leaves it out, the table is printed as it goes;
+// f doing the work of values calls is reported per call
+template<size_t N, typename F>
+void run(const char* op, F&& f, size_t values = 1){
+    if(opt.filter && !std::strstr(op, opt.filter)) return;
+    constexpr size_t limbs = bigint::s<N>::segments_count;
+    auto [ns, reps] = time_ns(f);
+    ns /= values;
+    results.push_back({ op, N, limbs, reps, ns });
+    if(!opt.json)
+        std::printf("%-10s %-16s %8zu %14.2f %10.3f\n", STRINGIFY(BIGINT_IMPL_TYPE), op, N, ns, ns / limbs);
+}
+
+// an mpz_t for the length of a scope
+struct mpz{
+    mpz_t v;
+    mpz()  { mpz_init(v); }
+    ~mpz() { mpz_clear(v); }
+    operator mpz_ptr() { return v; }
+};
+
+template<size_t N>
+bigint::s<N> random_bigint(){
+    std::vector<uint64_t> data(N / 64);
+    for(auto& d : data) d = mt64();
+    bigint::s<N> ret;
+    ret.import(data.data(), data.size());
+    return ret;
+}
+
+template<size_t N>
+void to_mpz(mpz_t x, const bigint::s<N>& b){
+    bigint::detail::limb_view v = b.limbs();
+    mpz_import(x, v.size, -1, sizeof(*v.data), 0, 0, v.data);
+}
+
+template<size_t N>
+void bench_size(){
+    if(N > opt.max_bits) return;
+
+    auto a = random_bigint<N>();
+    auto b = random_bigint<N>();
+    mpz ga, gb, gr;
+    to_mpz(ga, a);
+    to_mpz(gb, b);
+
+    // linear in the width
+    run<N>("add",         [&]{ sink = (a + b).get_segment(0); });
+    run<N>("add_gmp",     [&]{ mpz_add(gr, ga, gb); sink = mpz_getlimbn(gr, 0); });
+    run<N>("sub",         [&]{ sink = (a - b).get_segment(0); });
+    run<N>("sub_gmp",     [&]{ mpz_sub(gr, ga, gb); sink = mpz_getlimbn(gr, 0); });
+    bigint::s<N> acc = a;
+    mpz_set(gr, ga);
+    run<N>("add_assign",     [&]{ acc += b; sink = acc.get_segment(0); });
+    run<N>("add_assign_gmp", [&]{ mpz_add(gr, gr, gb); sink = mpz_getlimbn(gr, 0); });
+    run<N>("compare",     [&]{ sink = (a < b); });
+    run<N>("compare_gmp", [&]{ sink = (mpz_cmp(ga, gb) < 0); });
+    run<N>("shift",       [&]{ sink = (a << (size_t)13).get_segment(1); });
+    run<N>("shift_gmp",   [&]{ mpz_mul_2exp(gr, ga, 13); sink = mpz_getlimbn(gr, 1); });
+    run<N>("div10",       [&]{ sink = (a / 10u).get_segment(0); });
+    run<N>("div10_gmp",   [&]{ mpz_tdiv_q_ui(gr, ga, 10); sink = mpz_getlimbn(gr, 0); });
+
+    // gmp style word buffers, the little-endian copy and the network order reversal
+    std::vector<uint8_t> wire(N / 8);
+    size_t words = N / 64, count;
+    bigint::s<N> imported;
+    run<N>("import",        [&]{ imported.import(wire.data(), words, -1, 8, -1); sink = imported.get_segment(0); });
+    run<N>("import_gmp",    [&]{ mpz_import(gr, words, -1, 8, -1, 0, wire.data()); sink = mpz_getlimbn(gr, 0); });
+    run<N>("import_be",     [&]{ imported.import(wire.data(), words, 1, 8, 1); sink = imported.get_segment(0); });
+    run<N>("import_be_gmp", [&]{ mpz_import(gr, words, 1, 8, 1, 0, wire.data()); sink = mpz_getlimbn(gr, 0); });
+    run<N>("export",        [&]{ sink = a.export_to(wire.data(), -1, 8, -1); });
+    run<N>("export_gmp",    [&]{ mpz_export(wire.data(), &count, -1, 8, -1, 0, ga); sink = count; });
+    run<N>("export_be",     [&]{ sink = a.export_to(wire.data(), 1, 8, 1); });
+    run<N>("export_be_gmp", [&]{ mpz_export(wire.data(), &count, 1, 8, 1, 0, ga); sink = count; });
+
+    // base 16 and base 2 text, formatting into a buffer sized once
+    std::vector<char> text(a.to_binary(nullptr, 0) + 2);
+    std::string hex = a.to_hex(), bin = a.to_binary();
+    bigint::s<N> parsed;
+    run<N>("to_hex",          [&]{ sink = a.to_hex(text.data(), text.size()); });
+    run<N>("to_hex_gmp",      [&]{ mpz_get_str(text.data(), 16, ga); sink = text[0]; });
+    run<N>("from_hex",        [&]{ parsed.from_hex(hex); sink = parsed.get_segment(0); });
+    run<N>("from_hex_gmp",    [&]{ mpz_set_str(gr, hex.c_str(), 16); sink = mpz_getlimbn(gr, 0); });
+    run<N>("to_binary",       [&]{ sink = a.to_binary(text.data(), text.size()); });
+    run<N>("to_binary_gmp",   [&]{ mpz_get_str(text.data(), 2, ga); sink = text[0]; });
+    run<N>("from_binary",     [&]{ parsed.from_binary(bin); sink = parsed.get_segment(0); });
+    run<N>("from_binary_gmp", [&]{ mpz_set_str(gr, bin.c_str(), 2); sink = mpz_getlimbn(gr, 0); });
+
+    // every tier of mul_any, the data for picking crossovers
+    run<N>("mul",        [&]{ sink = (a * b).get_segment(0); });
+    run<N>("mul_gmp",    [&]{ mpz_mul(gr, ga, gb); sink = mpz_getlimbn(gr, 0); });
+    run<N>("square",     [&]{ sink = bigint::square(a).get_segment(0); });
+    run<N>("square_gmp", [&]{ mpz_mul(gr, ga, ga); sink = mpz_getlimbn(gr, 0); });
+    // the floating point tier on its own, mul_u only reaches it between the FFT and NTT thresholds
+    if constexpr (N >= 1024)
+        run<N>("mul_fft", [&]{ sink = bigint::mul_fft(a, b).get_segment(0); });
+
+    // a*b + b*a - a, wider temporaries per operator against one fused pass
+    bigint::s<2*N + 2> fused;
+    run<N>("muladd",      [&]{ fused = a*b + b*a - a; sink = fused.get_segment(0); });
+    run<N>("muladd_lazy", [&]{ fused = bigint::lazy(a)*b + b*a - a; sink = fused.get_segment(0); });
+    run<N>("muladd_gmp",  [&]{ mpz_mul(gr, ga, gb); mpz_addmul(gr, gb, ga); mpz_sub(gr, gr, ga); sink = mpz_getlimbn(gr, 0); });
+
+    // N by N/2 bits
+    if constexpr (N >= 128){
+        auto h = random_bigint<N/2>();
+        mpz gh, gq;
+        to_mpz(gh, h);
+        run<N>("div",     [&]{ sink = bigint::divmod(a, h).first.get_segment(0); });
+        run<N>("div_gmp", [&]{ mpz_tdiv_qr(gq, gr, ga, gh); sink = mpz_getlimbn(gq, 0); });
+    }
+
+    // base 10 text both ways
+    if constexpr (N <= ((size_t)1 << 20)){
+        std::string dec = a.to_decimal();
+        run<N>("to_dec",       [&]{ sink = a.to_decimal().size(); });
+        run<N>("to_dec_gmp",   [&]{ mpz_get_str(text.data(), 10, ga); sink = text[0]; });
+        run<N>("from_dec",     [&]{ parsed.from_decimal(dec); sink = parsed.get_segment(0); });
+        run<N>("from_dec_gmp", [&]{ mpz_set_str(gr, dec.c_str(), 10); sink = mpz_getlimbn(gr, 0); });
+    }
+
+    // modular products against an odd modulus of the same width, quadratic from here on
+    if constexpr (N <= 131072){
+        bigint::s<N> m = b;
+        if(!m.bit_at(0)) m = m + bigint::s<8>(1);
+        mpz gm;
+        to_mpz(gm, m);
+        bigint::Montgomery<N> mont(m);
+        auto am = mont.to_mont(a);
+        run<N>("montmul", [&]{ sink = mont.mul(am, am).get_segment(0); });
+        run<N>("montsqr", [&]{ sink = mont.sqr(am).get_segment(0); });
+
+        // reducing a full product, precomputed reciprocal against a division
+        bigint::Barrett<N> red(m);
+        auto p = a * b;
+        mpz gp;
+        to_mpz(gp, p);
+        run<N>("barrett", [&]{ sink = red.reduce(p).get_segment(0); });
+        run<N>("mod",     [&]{ sink = (p % m).get_segment(0); });
+        run<N>("mod_gmp", [&]{ mpz_tdiv_r(gr, gp, gm); sink = mpz_getlimbn(gr, 0); });
+
+        if constexpr (N <= 4096){
+            run<N>("powmod",     [&]{ sink = bigint::powmod(a, b, m).get_segment(0); });
+            run<N>("powmod_gmp", [&]{ mpz_powm(gr, ga, gb, gm); sink = mpz_getlimbn(gr, 0); });
+        }
+    }
+
+    // per value cost of the structure of arrays kernels over a run of values,
+    // against the same run through mpz_t one at a time
+    if constexpr (N <= 4096){
+        constexpr size_t count = 256;
+        constexpr BIGINT_IMPL_TYPE v = (BIGINT_IMPL_TYPE)0x9E3779B9u;
+        bigint::s<N> m = b;
+        if(!m.bit_at(0)) m = m + bigint::s<8>(1);
+        bigint::Montgomery<N> mont(m);
+        bigint::batch<N> ba(count), bb(count), bm(count);
+        std::vector<mpz> ma(count), mb(count), mr(count);
+        for(size_t i=0; i<count; i++){
+            auto x = random_bigint<N>(), y = random_bigint<N>();
+            if(i % 2) x.toggle_sign();
+            ba.set(i, x); bb.set(i, y);
+            bm.set(i, mont.to_mont(y));
+            to_mpz(ma[i], x); to_mpz(mb[i], y);
+            if(i % 2) mpz_neg(ma[i], ma[i]);
+        }
+        run<N>("batch_add",       [&]{ sink = (ba + bb).limb(0)[0]; }, count);
+        run<N>("batch_add_gmp",   [&]{ for(size_t i=0; i<count; i++) mpz_add(mr[i], ma[i], mb[i]);
+                                       sink = mpz_getlimbn(mr[0], 0); }, count);
+        run<N>("batch_cmp",       [&]{ sink = bigint::cmp(ba, bb)[0]; }, count);
+        run<N>("batch_cmp_gmp",   [&]{ for(size_t i=0; i<count; i++) sink = mpz_cmp(ma[i], mb[i]); }, count);
+        run<N>("batch_mul_1",     [&]{ sink = (ba * v).limb(0)[0]; }, count);
+        run<N>("batch_mul_1_gmp", [&]{ for(size_t i=0; i<count; i++) mpz_mul_ui(mr[i], ma[i], v);
+                                       sink = mpz_getlimbn(mr[0], 0); }, count);
+        run<N>("batch_montmul",   [&]{ sink = bigint::mul(mont, bm, bm).limb(0)[0]; }, count);
+    }
+}
+
+template<size_t... Ks>
+void sweep(std::index_sequence<Ks...>){
+    (bench_size<(size_t)64 << Ks>(), ...);
+}
+
+void write_json(FILE* f){
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::fprintf(f, "{\n  \"context\": {\n");
+    std::fprintf(f, "    \"date\": \"%s\",\n", date);
+    std::fprintf(f, "    \"executable\": \"bench_%s\",\n", STRINGIFY(BIGINT_IMPL_TYPE));
+    std::fprintf(f, "    \"library_build_type\": \"release\",\n");
+    std::fprintf(f, "    \"limb\": \"%s\",\n", STRINGIFY(BIGINT_IMPL_TYPE));
+    std::fprintf(f, "    \"karatsuba_threshold\": %d,\n", BIGINT_KARATSUBA_THRESHOLD);
+    std::fprintf(f, "    \"toom3_threshold\": %d,\n", BIGINT_TOOM3_THRESHOLD);
+    std::fprintf(f, "    \"fft_threshold\": %d,\n", BIGINT_FFT_THRESHOLD);
+    std::fprintf(f, "    \"ntt_threshold\": %d,\n", BIGINT_NTT_THRESHOLD);
+    std::fprintf(f, "    \"div_dc_threshold\": %d,\n", BIGINT_DIV_DC_THRESHOLD);
+    std::fprintf(f, "    \"dec_dc_threshold\": %d,\n", BIGINT_DEC_DC_THRESHOLD);
+    std::fprintf(f, "    \"parallel_threshold\": %d,\n", BIGINT_PARALLEL_THRESHOLD);
+    std::fprintf(f, "    \"threads\": %zu,\n", bigint::threads());
+    std::fprintf(f, "    \"gmp_version\": \"%s\"\n", gmp_version);
+    std::fprintf(f, "  },\n  \"benchmarks\": [");
+    for(size_t i=0; i<results.size(); i++){
+        const result& r = results[i];
+        std::string name = r.op + "/" + std::to_string(r.bits);
+        std::fprintf(f, "%s\n    {\n", i ? "," : "");
+        std::fprintf(f, "      \"name\": \"%s\",\n", name.c_str());
+        std::fprintf(f, "      \"run_name\": \"%s\",\n", name.c_str());
+        std::fprintf(f, "      \"run_type\": \"iteration\",\n");
+        std::fprintf(f, "      \"iterations\": %zu,\n", r.iterations);
+        std::fprintf(f, "      \"real_time\": %.3f,\n", r.ns);
+        std::fprintf(f, "      \"cpu_time\": %.3f,\n", r.ns);
+        std::fprintf(f, "      \"time_unit\": \"ns\",\n");
+        std::fprintf(f, "      \"op\": \"%s\",\n", r.op.c_str());
+        std::fprintf(f, "      \"bits\": %zu,\n", r.bits);
+        std::fprintf(f, "      \"limbs\": %zu,\n", r.limbs);
+        std::fprintf(f, "      \"ns_per_limb\": %.4f\n", r.ns / r.limbs);
+        std::fprintf(f, "    }");
+    }
+    std::fprintf(f, "\n  ]\n}\n");
+}
+
+int main(int argc, char** argv){
+    for(int i=1; i<argc; i++){
+        if(!std::strcmp(argv[i], "--json"))                 opt.json = true;
+        else if(!std::strncmp(argv[i], "--out=", 6))        opt.out = argv[i] + 6;
+        else if(!std::strncmp(argv[i], "--filter=", 9))     opt.filter = argv[i] + 9;
+        else if(!std::strncmp(argv[i], "--max-bits=", 11))  opt.max_bits = std::strtoull(argv[i] + 11, nullptr, 10);
+        else if(!std::strncmp(argv[i], "--threads=", 10))   opt.threads = std::strtoull(argv[i] + 10, nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: %s [--json] [--out=file] [--filter=op] [--max-bits=n] [--threads=n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bigint::set_threads(opt.threads);
+    if(!opt.json) std::printf("%-10s %-16s %8s %14s %10s\n", "limb", "op", "bits", "ns", "ns/limb");
+    // 64 bits to 2^21 bits
+    sweep(std::make_index_sequence<16>());
+
+    if(opt.json){
+        FILE* f = opt.out ? std::fopen(opt.out, "w") : stdout;
+        if(!f){ std::perror(opt.out); return 1; }
+        write_json(f);
+        if(f != stdout) std::fclose(f);
+    }
+}
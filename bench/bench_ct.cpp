@@ -0,0 +1,112 @@
+// timing spread of the constant time operations across inputs, next to their
+// variable time counterparts; the ct rows should stay flat within noise
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "bigint.h"
+
+#define STRINGIFY_(x) #x
+#define STRINGIFY(x) STRINGIFY_(x)
+
+std::mt19937_64 mt64(0);
+volatile uint64_t sink;
+
+// best of five runs, in nanoseconds per call
+template<typename F>
+double time_ns(F&& f){
+    using clock = std::chrono::steady_clock;
+    size_t reps = 1;
+    for(;;){
+        auto start = clock::now();
+        for(size_t i=0; i<reps; i++) f();
+        if(clock::now() - start > std::chrono::milliseconds(20)) break;
+        reps *= 2;
+    }
+    double best = 1e300;
+    for(int run=0; run<5; run++){
+        auto start = clock::now();
+        for(size_t i=0; i<reps; i++) f();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        best = std::min(best, elapsed.count() / reps);
+    }
+    return best;
+}
+
+// classes are timed round robin so a burst of noise does not land on one of them
+constexpr int passes = 3;
+
+template<size_t N>
+bigint::s<N> from_words(const std::vector<uint64_t>& data){
+    bigint::s<N> ret;
+    ret.import(data.data(), data.size());
+    return ret;
+}
+
+// one row per input class, then the relative spread (max - min) / min
+void report(const char* op, size_t bits, const std::vector<const char*>& names, const std::vector<double>& ns){
+    for(size_t i=0; i<ns.size(); i++)
+        std::printf("%-10s %-12s %8zu %-10s %12.2f\n", STRINGIFY(BIGINT_IMPL_TYPE), op, bits, names[i], ns[i]);
+    auto [lo, hi] = std::minmax_element(ns.begin(), ns.end());
+    std::printf("%-10s %-12s %8zu %-10s %11.2f%%\n", STRINGIFY(BIGINT_IMPL_TYPE), op, bits, "spread", 100 * (*hi - *lo) / *lo);
+}
+
+template<size_t N>
+void bench_size(){
+    constexpr size_t words = N / 64;
+    std::vector<uint64_t> dm(words), db(words);
+    for(auto& d : dm) d = mt64();
+    for(auto& d : db) d = mt64();
+    dm[0] |= 1;
+    dm[words-1] |= (uint64_t)1 << 63;
+
+    // exponents from the cheapest to the most expensive for the sliding window
+    std::vector<const char*> names = { "zero", "one", "sparse", "random", "ones" };
+    std::vector<std::vector<uint64_t>> exps(names.size(), std::vector<uint64_t>(words, 0));
+    exps[1][0] = 1;
+    exps[2][words-1] = (uint64_t)1 << 63;
+    exps[2][0] = 1;
+    for(auto& d : exps[3]) d = mt64();
+    for(auto& d : exps[4]) d = (uint64_t)-1;
+
+    auto m = from_words<N>(dm);
+    bigint::Montgomery<N> mont(m);
+    auto b = from_words<N>(db) % m;
+
+    std::vector<double> ct_ns(exps.size(), 1e300), vt_ns(exps.size(), 1e300);
+    for(int pass=0; pass<passes; pass++){
+        for(size_t c=0; c<exps.size(); c++){
+            auto e = from_words<N>(exps[c]);
+            ct_ns[c] = std::min(ct_ns[c], time_ns([&]{ sink = bigint::ct::powmod(b, e, mont).get_segment(0); }));
+            vt_ns[c] = std::min(vt_ns[c], time_ns([&]{ sink = bigint::powmod(b, e, m).get_segment(0); }));
+        }
+    }
+    report("ct_powmod", N, names, ct_ns);
+    report("powmod",    N, names, vt_ns);
+
+    // comparisons exiting at the top limb against ones running to the bottom
+    std::vector<const char*> cmp_names = { "top", "bottom", "equal" };
+    std::vector<bigint::s<N>> rhs(3, b);
+    rhs[0] = b + (bigint::s<N>(1) << (size_t)(N - 2));
+    rhs[1] = b + bigint::s<8>(1);
+    std::vector<double> ct_cmp(rhs.size(), 1e300), vt_cmp(rhs.size(), 1e300);
+    for(int pass=0; pass<passes; pass++){
+        for(size_t c=0; c<rhs.size(); c++){
+            const bigint::s<N>& r = rhs[c];
+            ct_cmp[c] = std::min(ct_cmp[c], time_ns([&]{ sink = bigint::ct::cmp(b, r); }));
+            vt_cmp[c] = std::min(vt_cmp[c], time_ns([&]{ sink = (b < r); }));
+        }
+    }
+    report("ct_cmp", N, cmp_names, ct_cmp);
+    report("compare", N, cmp_names, vt_cmp);
+}
+
+int main(){
+    std::printf("%-10s %-12s %8s %-10s %12s\n", "limb", "op", "bits", "input", "ns");
+    bench_size<1024>();
+    bench_size<2048>();
+}
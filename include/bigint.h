@@ -3,20 +3,75 @@
 #include <algorithm>
 #include <complex>
 #include <vector>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 #include <iostream>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 #include <assert.h>
 #include <array>
+#include <cstring>
 #include <stdint.h>
 #include <math.h>
+#if defined(__x86_64__)
+    #include <immintrin.h>
+#endif
 
 #ifndef BIGINT_IMPL_TYPE
-    #define BIGINT_IMPL_TYPE uint8_t
+    #define BIGINT_IMPL_TYPE uint64_t
 #else
     static_assert(std::is_integral<BIGINT_IMPL_TYPE>::value);
     static_assert(std::is_unsigned<BIGINT_IMPL_TYPE>::value);
 #endif
 
+// multiplication crossovers, in limbs of the smaller operand
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+    #define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef BIGINT_TOOM3_THRESHOLD
+    #define BIGINT_TOOM3_THRESHOLD 96
+#endif
+// the FFT splits into chunks of a dozen or so bits whatever the limb, so wider
+// limbs push its crossover with Toom-3 out; it ties the NTT near 2^21 bits
+#ifndef BIGINT_FFT_THRESHOLD
+    #define BIGINT_FFT_THRESHOLD (sizeof(BIGINT_IMPL_TYPE) >= 8 ? 16384 : sizeof(BIGINT_IMPL_TYPE) >= 4 ? 4096 : 128)
+#endif
+#ifndef BIGINT_NTT_THRESHOLD
+    #define BIGINT_NTT_THRESHOLD (2097152 / (8 * (int)sizeof(BIGINT_IMPL_TYPE)))
+#endif
+static_assert(BIGINT_FFT_THRESHOLD <= BIGINT_NTT_THRESHOLD);
+// divisor limbs from which division recurses instead of running schoolbook
+#ifndef BIGINT_DIV_DC_THRESHOLD
+    #define BIGINT_DIV_DC_THRESHOLD 64
+#endif
+// limbs from which decimal conversion splits by cached powers of ten
+#ifndef BIGINT_DEC_DC_THRESHOLD
+    #define BIGINT_DEC_DC_THRESHOLD 40
+#endif
+// smaller operand limbs from which products fork onto the thread pool
+#ifndef BIGINT_PARALLEL_THRESHOLD
+    #define BIGINT_PARALLEL_THRESHOLD 1024
+#endif
+// threads for those products, 1 keeps them serial and 0 uses every hardware thread;
+// changed at run time with set_threads
+#ifndef BIGINT_THREADS
+    #define BIGINT_THREADS 1
+#endif
+// limb arrays wider than this many bits live on the heap
+#ifndef BIGINT_HEAP_THRESHOLD
+    #define BIGINT_HEAP_THRESHOLD 16384
+#endif
+static_assert(BIGINT_KARATSUBA_THRESHOLD >= 2);
+static_assert(BIGINT_TOOM3_THRESHOLD >= 5);
+static_assert(BIGINT_DIV_DC_THRESHOLD >= 4);
+
 namespace bigint{
 //DEBUG
 template<typename ...Ts> void print(Ts... ts){
@@ -24,7 +79,14 @@ template<typename ...Ts> void print(Ts... ts){
 template<typename ...Ts> void log(Ts... ts){ print(ts..., '\n'); }
 //DEBUG
 namespace{
+    template<typename T> struct double_width{};
+    template<> struct double_width<uint8_t>  { using type = uint16_t; };
+    template<> struct double_width<uint16_t> { using type = uint32_t; };
+    template<> struct double_width<uint32_t> { using type = uint64_t; };
+    template<> struct double_width<uint64_t> { __extension__ typedef unsigned __int128 type; };
+
     using impl_t = BIGINT_IMPL_TYPE;
+    using dimpl_t = typename double_width<impl_t>::type;
     constexpr size_t impl_t_byte_sz = sizeof(impl_t);
     constexpr size_t impl_t_bit_sz = sizeof(impl_t)*8;
 }
@@ -37,6 +99,85 @@ constexpr static size_t MSB(size_t n){
     else{       return (n >> 1);     }
 }
 
+// std::max and std::min are templates, gcc does not match them between
+// friend declarations and definitions when they appear in return types
+constexpr static size_t max_sz(size_t a, size_t b){ return a > b ? a : b; }
+constexpr static size_t min_sz(size_t a, size_t b){ return a < b ? a : b; }
+
+namespace detail{
+    // fixed count of limbs in an owned heap block, deep copies, moves steal the block;
+    // a moved-from value can only be assigned to or destroyed
+    template<size_t N>
+    class heap_limbs{
+    public:
+        heap_limbs() : _p(new impl_t[N]()) {}
+        heap_limbs(const heap_limbs& other) : _p(new impl_t[N]) { copy_from(other); }
+        heap_limbs(heap_limbs&& other) noexcept : _p(std::move(other._p)) {}
+
+        heap_limbs& operator=(const heap_limbs& other){
+            if(this == &other) return *this;
+            if(!_p) _p.reset(new impl_t[N]);
+            copy_from(other);
+            return *this;
+        }
+        heap_limbs& operator=(heap_limbs&& other) noexcept {
+            _p.swap(other._p);
+            return *this;
+        }
+
+        impl_t&       operator[](size_t i)       { return _p[i]; }
+        const impl_t& operator[](size_t i) const { return _p[i]; }
+        impl_t&       at(size_t i)       { assert(i < N); return _p[i]; }
+        const impl_t& at(size_t i) const { assert(i < N); return _p[i]; }
+
+        impl_t*       data()       { return _p.get(); }
+        const impl_t* data() const { return _p.get(); }
+        impl_t*       begin()       { return _p.get(); }
+        const impl_t* begin() const { return _p.get(); }
+        impl_t*       end()       { return _p ? _p.get() + N : nullptr; }
+        const impl_t* end() const { return _p ? _p.get() + N : nullptr; }
+        constexpr static size_t size() { return N; }
+
+    private:
+        void copy_from(const heap_limbs& other){
+            if(other._p) std::copy(other.begin(), other.end(), _p.get());
+            else         std::fill(_p.get(), _p.get() + N, 0);
+        }
+
+        std::unique_ptr<impl_t[]> _p;
+    };
+
+    // small counts stay a plain inline std::array
+    template<size_t N>
+    using limb_array = typename std::conditional<(N * impl_t_bit_sz > BIGINT_HEAP_THRESHOLD),
+                                                 heap_limbs<N>, std::array<impl_t, N>>::type;
+
+    // read-only little-endian limb range, how Signed<N> and Dynamic hand
+    // their magnitudes to the kernels
+    struct limb_view{
+        const impl_t* data;
+        size_t size;
+    };
+}
+
+class Dynamic;
+class View;
+template<size_t _SZ> class Signed;
+template<size_t _SZ> class Montgomery;
+template<size_t _SZ> class Barrett;
+template<typename Node> class Expr;
+
+// constant time operations on magnitudes, see "Constant time" below
+namespace ct{
+    template<size_t SZ> Signed<SZ+1> add(const Signed<SZ>& lhs, const Signed<SZ>& rhs);
+    template<size_t SZ> Signed<SZ+1> sub(const Signed<SZ>& lhs, const Signed<SZ>& rhs);
+    template<size_t SZ> Signed<SZ> select(bool cond, const Signed<SZ>& a, const Signed<SZ>& b);
+    template<size_t SZ>
+    Signed<SZ> mul(const Montgomery<SZ>& mont, const Signed<SZ>& a, const Signed<SZ>& b);
+    template<size_t SZ, size_t SZ2>
+    Signed<SZ> powmod(const Signed<SZ>& base, const Signed<SZ2>& exp, const Montgomery<SZ>& mont);
+}
+
 template<size_t _SZ>
 class Signed{
 
@@ -56,17 +197,25 @@ public:
     template<size_t SZ> 
     Signed(const Signed<SZ>& other);
 
+    // reads limbs in place, TRUNCATED is set when the value does not fit
+    explicit Signed(const View& view);
+
+    // count little-endian words of native byte order
     template<typename T>
-    bool import(T* data, size_t count); // TODO: endianness options and stuff
+    bool import(T* data, size_t count);
+    // as mpz_import: count words of size bytes, order 1 most significant word first or -1
+    // least first, endian 1 big, -1 little, 0 native; the sign is cleared. Returns false
+    // and sets TRUNCATED when nonzero bytes do not fit
+    bool import(const void* data, size_t count, int order, size_t size, int endian);
+    // as mpz_export for the magnitude: writes export_count(size) words, none for zero,
+    // and returns that count
+    size_t export_to(void* data, int order, size_t size, int endian) const;
+    size_t export_count(size_t size) const { return ((real_bit_sz - clz() + 7) / 8 + size - 1) / size; }
+
+    detail::limb_view limbs() const { return { _segments.data(), segments_count }; }
 
     constexpr static size_t get_segments_count(){
-        if((_SZ-1) & ~_SZ) { 
-            return _SZ/(sizeof(impl_t)*8); }
-        else { 
-            size_t ceil_log_2 = (MSB(_SZ) << 1);
-            //static_assert( ceil_log_2 == 0);
-            return ceil_log_2/(sizeof(impl_t)*8);
-        }
+        return (_SZ + impl_t_bit_sz - 1) / impl_t_bit_sz;
     }
 
     constexpr static size_t segments_count = get_segments_count();
@@ -100,12 +249,7 @@ public:
             else break;
         }
         if(i != segments_count){
-            impl_t mask, j = 0;
-            do{
-                j++;
-                mask = (impl_t)pow(2, j)-1;
-            } while( !(_segments[i] & mask) );
-            ret += j - 1;
+            ret += __builtin_ctzll((unsigned long long)_segments[i]);
         }
         return ret;
     }
@@ -116,44 +260,43 @@ public:
             else break;
         }
         if(i != 0){
-            impl_t mask; size_t j = impl_t_bit_sz;
-            do{
-                j--;
-                mask = ~((impl_t)pow(2, j)-1);
-            } while( !(_segments[i-1] & mask) );
-            ret += impl_t_bit_sz - j-1;
+            ret += __builtin_clzll((unsigned long long)_segments[i-1]) - (64 - impl_t_bit_sz);
         }
         return ret;
     }
 
 
-    std::string binary_string() const {
-        // size_t real_sz = _SZ - clz();
-        std::string str; 
-        str.resize(_SZ);
-        // str.at(0) = is_negative() ? '-' : '+';
-        // for(size_t i=0; i < real_sz; i++)
-        //     str[real_sz - i - 1] = bit_at(i) + 48;
+    // all _SZ bits zero padded, no sign
+    std::string binary_string() const;
 
-        for(size_t i=0; i < _SZ; i++)
-            str[_SZ - i - 1] = bit_at(i) + 48;
-        return str;
-    }
+    std::string decimal_string() const { return to_decimal(); }
 
-    std::string decimal_string() const {
-        size_t real_sz = _SZ - clz();
-        //str.at(0) = is_negative() ? '-' : '+';
-        size_t num = 0;
-        for(size_t i=0; i < real_sz; i++)
-            num += bit_at(i) * pow(2,i);
-        std::string str = std::to_string(num);
-        return str;
-    }
+    // base 10, a leading '-' for negatives
+    std::string to_decimal() const;
+    // an optional sign and decimal digits; anything else returns false and leaves zero,
+    // TRUNCATED is set when the value does not fit
+    bool from_decimal(std::string_view str);
+
+    // base 16 and base 2, lowercase, no prefix, a leading '-' for negatives; the buffer
+    // versions return the length and write nothing when size falls short of it
+    size_t to_hex(char* buf, size_t size) const;
+    size_t to_binary(char* buf, size_t size) const;
+    std::string to_hex() const;
+    std::string to_binary() const;
+    // as from_decimal, upper or lower case hex digits
+    bool from_hex(std::string_view str);
+    bool from_binary(std::string_view str);
 
 // Assignment
     template<size_t SZ>
     Signed<_SZ>& operator=(const Signed<SZ>& other);
 
+    // evaluates a lazy(...) expression in one pass, see "Expression templates" below
+    template<typename Node>
+    Signed(const Expr<Node>& expr);
+    template<typename Node>
+    Signed<_SZ>& operator=(const Expr<Node>& expr);
+
 
 // Type Conversions
     operator bool() const { return !is_zero(); }
@@ -161,47 +304,48 @@ public:
 // Arithmetic Operators
     //add unsigned
     template<size_t SZ1, size_t SZ2> 
-    friend Signed<std::max(SZ1, SZ2)+1> add_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+    friend Signed<max_sz(SZ1, SZ2)+1> add_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
     //operator+
     template<size_t SZ, typename T>
-    friend inline Signed<std::max(SZ,sizeof(T)*8)+1> operator+(const Signed<SZ>& lhs, T rhs);
+    friend inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator+(const Signed<SZ>& lhs, T rhs);
 
     template<size_t SZ, typename T>
-    friend inline Signed<std::max(SZ,sizeof(T)*8)+1> operator+(T lhs, const Signed<SZ>& rhs);
+    friend inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator+(T lhs, const Signed<SZ>& rhs);
 
     template<size_t SZ1, size_t SZ2>
-    friend inline Signed<std::max(SZ1,SZ2)+1> operator+(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
-
-    //operator+=
-    // template<size_t SZ, typename T>
-    // friend inline Signed<std::max(SZ,sizeof(T)*8)+1> operator+=(const Signed<SZ>& lhs, T rhs);
-
-    // template<size_t SZ, typename T>
-    // friend inline Signed<std::max(SZ,sizeof(T)*8)+1> operator+=(T lhs, const Signed<SZ>& rhs);
+    friend inline Signed<max_sz(SZ1,SZ2)+1> operator+(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
+    //operator+=, in place, TRUNCATED only when the carry does not fit
     template<size_t SZ1, size_t SZ2>
     friend inline Signed<SZ1>& operator+=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
- 
 
 
     //add unsigned
     template<size_t SZ1, size_t SZ2> 
-    friend Signed<std::max(SZ1,SZ2)+1> sub_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+    friend Signed<max_sz(SZ1,SZ2)+1> sub_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
     //operator-
     template<size_t SZ, typename T>
-    friend inline Signed<std::max(SZ,sizeof(T)*8)+1> operator-(T lhs, const Signed<SZ>& rhs);
+    friend inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator-(T lhs, const Signed<SZ>& rhs);
 
     template<size_t SZ, typename T>
-    friend inline Signed<std::max(SZ,sizeof(T)*8)+1> operator-(const Signed<SZ>& lhs, T rhs);
+    friend inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator-(const Signed<SZ>& lhs, T rhs);
+
+    template<size_t SZ1, size_t SZ2>
+    friend inline Signed<max_sz(SZ1,SZ2)+1> operator-(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
+    //operator-=
     template<size_t SZ1, size_t SZ2>
-    friend inline Signed<std::max(SZ1,SZ2)+1> operator-(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+    friend inline Signed<SZ1>& operator-=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
     //multiply unsigned
     template<size_t SZ1, size_t SZ2> 
-    friend Signed<SZ1+SZ2> mul_u(const Signed<SZ1>& lhs, Signed<SZ2> rhs);
+    friend Signed<SZ1+SZ2> mul_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+
+    //multiply unsigned through a floating point FFT
+    template<size_t SZ1, size_t SZ2> 
+    friend Signed<SZ1+SZ2> mul_fft(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
     //operator*
     //template<size_t SZ, typename T>
@@ -213,6 +357,36 @@ public:
     template<size_t SZ1, size_t SZ2>
     friend inline Signed<SZ1+SZ2> operator*(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
+    //operator*=, keeps the low limbs of the product
+    template<size_t SZ1, size_t SZ2>
+    friend inline Signed<SZ1>& operator*=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+
+    //square unsigned
+    template<size_t SZ>
+    friend Signed<2*SZ> sqr_u(const Signed<SZ>& x);
+
+    //divide unsigned
+    template<size_t SZ1, size_t SZ2> 
+    friend std::pair<Signed<SZ1>, Signed<SZ2>> div_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+
+    //quotient and remainder, truncated towards zero
+    template<size_t SZ1, size_t SZ2> 
+    friend std::pair<Signed<SZ1>, Signed<SZ2>> divmod(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+
+    //operator/
+    template<size_t SZ, typename T>
+    friend inline Signed<SZ> operator/(const Signed<SZ>& lhs, T rhs);
+
+    template<size_t SZ1, size_t SZ2>
+    friend inline Signed<SZ1> operator/(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+
+    //operator%
+    template<size_t SZ, typename T>
+    friend inline Signed<sizeof(T)*8> operator%(const Signed<SZ>& lhs, T rhs);
+
+    template<size_t SZ1, size_t SZ2>
+    friend inline Signed<SZ2> operator%(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+
 // Uniary Operators
     //operator~
     template<size_t SZ>
@@ -226,11 +400,11 @@ public:
 
     //operator prefix--
     template<size_t SZ>
-    friend inline Signed<SZ>& operator--(Signed<SZ> lhs);
+    friend inline Signed<SZ>& operator--(Signed<SZ>& lhs);
 
     //operator postfix--
     template<size_t SZ>
-    friend inline Signed<SZ> operator--(Signed<SZ> lhs, int);
+    friend inline Signed<SZ> operator--(Signed<SZ>& lhs, int);
 
 // Binary Operators
     //operator<<
@@ -251,24 +425,36 @@ public:
 
     //operator&
     template<size_t SZ, typename T>
-    friend inline Signed<std::min(SZ, sizeof(T)*8)> operator&(const Signed<SZ>& lhs, const T rhs);
+    friend inline Signed<min_sz(SZ, sizeof(T)*8)> operator&(const Signed<SZ>& lhs, const T rhs);
+
+    template<size_t SZ1, size_t SZ2>
+    friend inline Signed<min_sz(SZ1, SZ2)> operator&(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
+    //operator&=
     template<size_t SZ1, size_t SZ2>
-    friend inline Signed<std::min(SZ1, SZ2)> operator&(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+    friend inline Signed<SZ1>& operator&=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
     //operator|
     template<size_t SZ, typename T>
-    friend inline Signed<std::max(SZ, sizeof(T)*8)> operator|(const Signed<SZ>& lhs, const T rhs);
+    friend inline Signed<max_sz(SZ, sizeof(T)*8)> operator|(const Signed<SZ>& lhs, const T rhs);
 
     template<size_t SZ1, size_t SZ2>
-    friend inline Signed<std::max(SZ1, SZ2)> operator|(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+    friend inline Signed<max_sz(SZ1, SZ2)> operator|(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+
+    //operator|=
+    template<size_t SZ1, size_t SZ2>
+    friend inline Signed<SZ1>& operator|=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
     //operator^
     template<size_t SZ, typename T>
-    friend inline Signed<std::max(SZ, sizeof(T)*8)> operator^(const Signed<SZ>& lhs, const T rhs);
+    friend inline Signed<max_sz(SZ, sizeof(T)*8)> operator^(const Signed<SZ>& lhs, const T rhs);
+
+    template<size_t SZ1, size_t SZ2>
+    friend inline Signed<max_sz(SZ1, SZ2)> operator^(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
+    //operator^=
     template<size_t SZ1, size_t SZ2>
-    friend inline Signed<std::max(SZ1, SZ2)> operator^(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
+    friend inline Signed<SZ1>& operator^=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
 // Relational Operators
     // is lhs greater
@@ -300,17 +486,284 @@ public:
     friend inline bool operator>=  (const Signed<SZ1>& lhs, const Signed<SZ2>& rhs);
 
 private:
-    std::array<impl_t, segments_count> _segments = {};
+    friend class Dynamic;
+    template<size_t SZ> friend class Montgomery;
+    template<size_t SZ> friend class Barrett;
+
+    template<size_t SZ> friend Signed<SZ+1> ct::add(const Signed<SZ>& lhs, const Signed<SZ>& rhs);
+    template<size_t SZ> friend Signed<SZ+1> ct::sub(const Signed<SZ>& lhs, const Signed<SZ>& rhs);
+    template<size_t SZ> friend Signed<SZ> ct::select(bool cond, const Signed<SZ>& a, const Signed<SZ>& b);
+    template<size_t SZ>
+    friend Signed<SZ> ct::mul(const Montgomery<SZ>& mont, const Signed<SZ>& a, const Signed<SZ>& b);
+    template<size_t SZ, size_t SZ2>
+    friend Signed<SZ> ct::powmod(const Signed<SZ>& base, const Signed<SZ2>& exp, const Montgomery<SZ>& mont);
+
+    // copies count limbs, flags truncation when nonzero limbs do not fit
+    void assign_segments(const impl_t* data, size_t count){
+        for(size_t i=0; i < segments_count; i++) _segments[i] = (i < count) ? data[i] : 0;
+        flags &= ~TRUNCATED;
+        for(size_t i = segments_count; i < count; i++)
+            if(data[i] != 0){ flags |= TRUNCATED; break; }
+    }
+
+    detail::limb_array<segments_count> _segments = {};
     uint8_t flags = 0;
-    double multiplication_error_bound;
+    // how far the furthest FFT coefficient was from its integer when mul_fft produced
+    // this value, zero for every other source
+    double multiplication_error_bound = 0;
 }; // class Signed
 
     template<size_t _SZ>
     using s = Signed<_SZ>;
+
+// runtime sized integer, no high zero limbs are kept and the limb vector
+// grows only when a carry runs out of room
+class Dynamic{
+public:
+    enum { 
+        NEGATIVE  = 1
+    };
+
+    Dynamic() = default;
+
+    template<typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    Dynamic(T val);
+
+    template<size_t SZ> 
+    explicit Dynamic(const Signed<SZ>& other);
+    explicit Dynamic(const View& view);
+
+    // TRUNCATED is set when the value does not fit
+    template<size_t SZ>
+    Signed<SZ> to_signed() const;
+
+    inline impl_t get_segment(size_t index) const {
+        return (index < _segments.size()) ? _segments[index] : 0;
+    }
+    size_t segments_count() const { return _segments.size(); }
+    detail::limb_view limbs() const { return { _segments.data(), _segments.size() }; }
+
+    inline bool     is_negative()   const { return  (flags & NEGATIVE);  }
+    inline bool     is_positive()   const { return !(flags & NEGATIVE);  }
+    inline int8_t   sign()          const { return (flags & NEGATIVE) ? -1 : 1; }
+    inline void     set_sign(bool s)      { flags &= ~NEGATIVE; flags |= NEGATIVE * (s && !is_zero()); }
+    inline void     toggle_sign()         { set_sign(!is_negative()); }
+    inline bool     is_zero()       const { return _segments.empty(); }
+
+    operator bool() const { return !is_zero(); }
+
+    friend inline Dynamic operator+(const Dynamic& lhs, const Dynamic& rhs);
+    friend inline Dynamic operator-(const Dynamic& lhs, const Dynamic& rhs);
+    friend inline Dynamic operator*(const Dynamic& lhs, const Dynamic& rhs);
+    friend inline Dynamic operator-(const Dynamic& lhs);
+
+    friend inline Dynamic& operator+=(Dynamic& lhs, const Dynamic& rhs);
+    friend inline Dynamic& operator-=(Dynamic& lhs, const Dynamic& rhs);
+    friend inline Dynamic& operator*=(Dynamic& lhs, const Dynamic& rhs);
+
+    friend inline bool operator==(const Dynamic& lhs, const Dynamic& rhs);
+    friend inline bool operator< (const Dynamic& lhs, const Dynamic& rhs);
+
+private:
+    // |lhs| + |rhs| with the sign of lhs
+    static Dynamic add_u(const Dynamic& lhs, const Dynamic& rhs);
+    // |lhs| - |rhs| with the sign of the difference
+    static Dynamic sub_u(const Dynamic& lhs, const Dynamic& rhs);
+
+    // drops high zero limbs, zero is never negative
+    void normalize(){
+        while(!_segments.empty() && _segments.back() == 0) _segments.pop_back();
+        if(_segments.empty()) flags &= ~NEGATIVE;
+    }
+
+    std::vector<impl_t> _segments;
+    uint8_t flags = 0;
+}; // class Dynamic
+
+// read-only value over limbs someone else owns, nothing is copied; data must be
+// aligned for impl_t and outlive the view
+class View{
+public:
+    View(const impl_t* data, size_t count, bool negative = false);
+
+    inline impl_t get_segment(size_t index) const { return (index < _size) ? _data[index] : 0; }
+    size_t segments_count() const { return _size; }
+    detail::limb_view limbs() const { return { _data, _size }; }
+
+    inline bool     is_negative()   const { return  _negative; }
+    inline bool     is_positive()   const { return !_negative; }
+    inline int8_t   sign()          const { return _negative ? -1 : 1; }
+    inline bool     is_zero()       const { return _size == 0; }
+
+private:
+    const impl_t* _data;
+    size_t _size;      // without high zero limbs
+    bool _negative;
+}; // class View
+
+// arithmetic modulo an odd positive Signed<_SZ>, values are kept in
+// Montgomery form x * R mod m with R = B^segments_count
+template<size_t _SZ>
+class Montgomery{
+public:
+    constexpr static size_t segments_count = Signed<_SZ>::segments_count;
+
+    explicit Montgomery(const Signed<_SZ>& modulus);
+
+    template<size_t SZ>
+    Signed<_SZ> to_mont(const Signed<SZ>& x) const;
+    Signed<_SZ> from_mont(const Signed<_SZ>& x) const;
+
+    Signed<_SZ> mul(const Signed<_SZ>& a, const Signed<_SZ>& b) const;
+    Signed<_SZ> sqr(const Signed<_SZ>& a) const;
+    Signed<_SZ> add(const Signed<_SZ>& a, const Signed<_SZ>& b) const;
+    Signed<_SZ> sub(const Signed<_SZ>& a, const Signed<_SZ>& b) const;
+
+    const Signed<_SZ>& modulus() const { return _m; }
+    // 1 in Montgomery form
+    const Signed<_SZ>& one()     const { return _one; }
+
+private:
+    template<size_t SZ>
+    friend Signed<SZ> ct::mul(const Montgomery<SZ>& mont, const Signed<SZ>& a, const Signed<SZ>& b);
+    template<size_t SZ, size_t SZ2>
+    friend Signed<SZ> ct::powmod(const Signed<SZ>& base, const Signed<SZ2>& exp, const Montgomery<SZ>& mont);
+
+    Signed<_SZ> _m;
+    Signed<_SZ> _r2;   // R^2 mod m
+    Signed<_SZ> _one;  // R mod m
+    impl_t _minv;      // -m^-1 mod B
+}; // class Montgomery
+
+// reduction modulo a positive Signed<_SZ> fixed up front, mu = floor(B^2n / m) with
+// n = segments_count replaces the division by two products; inputs span up to 2n limbs,
+// which covers every product of two Signed<_SZ>
+template<size_t _SZ>
+class Barrett{
+public:
+    constexpr static size_t segments_count = Signed<_SZ>::segments_count;
+
+    explicit Barrett(const Signed<_SZ>& modulus);
+
+    // x mod m in [0, m)
+    template<size_t SZ>
+    Signed<_SZ> reduce(const Signed<SZ>& x) const;
+
+    Signed<_SZ> mul(const Signed<_SZ>& a, const Signed<_SZ>& b) const { return reduce(a * b); }
+    Signed<_SZ> sqr(const Signed<_SZ>& a) const { return reduce(square(a)); }
+
+    const Signed<_SZ>& modulus() const { return _m; }
+    // 1 mod m
+    const Signed<_SZ>& one()     const { return _one; }
+
+private:
+    Signed<_SZ> _m;
+    Signed<_SZ> _one;
+    detail::limb_array<2 * segments_count + 1> _mu = {};
+    size_t _k;         // significant limbs of m
+    size_t _mun;       // significant limbs of mu
+}; // class Barrett
 } // namespace bigint
 
 // =================================================================================
+// Byte order
+//
+// Limbs against gmp style word buffers, byte k of a value is byte k % impl_t_byte_sz
+// of limb k / impl_t_byte_sz; whole copies when the layouts agree, one reversal when
+// they are exact mirrors, a byte at a time otherwise
 namespace bigint{
+namespace detail{
+    constexpr bool little_endian_host = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+    inline uint8_t limb_byte(const impl_t* a, size_t k){
+        return (uint8_t)(a[k / impl_t_byte_sz] >> (8 * (k % impl_t_byte_sz)));
+    }
+
+    inline void set_limb_byte(impl_t* a, size_t k, uint8_t v){
+        a[k / impl_t_byte_sz] |= (impl_t)((impl_t)v << (8 * (k % impl_t_byte_sz)));
+    }
+
+    // dst[0, n) = src[0, n) back to front, sixteen bytes per shuffle with SSSE3,
+    // eight per swap otherwise
+    inline void reverse_bytes(uint8_t* dst, const uint8_t* src, size_t n){
+        size_t i = 0;
+#if defined(__SSSE3__)
+        const __m128i mirror = _mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0);
+        for(; i + 16 <= n; i += 16){
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + n - 16 - i));
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(v, mirror));
+        }
+#endif
+        for(; i + 8 <= n; i += 8){
+            uint64_t w;
+            std::memcpy(&w, src + n - 8 - i, 8);
+            w = __builtin_bswap64(w);
+            std::memcpy(dst + i, &w, 8);
+        }
+        for(; i < n; i++) dst[i] = src[n - 1 - i];
+    }
+
+    // 0 whole copy, 1 reversal, 2 neither
+    inline int word_layout(int order, size_t size, int endian){
+        if(endian == 0) endian = little_endian_host ? -1 : 1;
+        if(size == 1) endian = order;
+        if(order == -1 && endian == -1 && little_endian_host) return 0;
+        if(order ==  1 && endian ==  1 && little_endian_host) return 1;
+        return 2;
+    }
+
+    // byte k of the value in a buffer of count words
+    inline size_t word_byte_offset(size_t k, size_t count, int order, size_t size, int endian){
+        if(endian == 0) endian = little_endian_host ? -1 : 1;
+        size_t w = k / size, b = k % size;
+        return (order == -1 ? w : count - 1 - w) * size + (endian == -1 ? b : size - 1 - b);
+    }
+
+    // a[0, n) = count words of size bytes at src, returns false when nonzero bytes do not fit
+    inline bool import_words(impl_t* a, size_t n, const void* src, size_t count, int order, size_t size, int endian){
+        const uint8_t* p = static_cast<const uint8_t*>(src);
+        size_t total = count * size, cap = n * impl_t_byte_sz, fit = min_sz(total, cap);
+        std::fill(a, a + n, 0);
+
+        switch(word_layout(order, size, endian)){
+        case 0:
+            std::memcpy(a, p, fit);
+            return std::all_of(p + fit, p + total, [](uint8_t b){ return b == 0; });
+        case 1:
+            reverse_bytes(reinterpret_cast<uint8_t*>(a), p + total - fit, fit);
+            return std::all_of(p, p + total - fit, [](uint8_t b){ return b == 0; });
+        default:
+            bool fits = true;
+            for(size_t k=0; k<total; k++){
+                uint8_t v = p[word_byte_offset(k, count, order, size, endian)];
+                if(k < cap) set_limb_byte(a, k, v);
+                else        fits &= (v == 0);
+            }
+            return fits;
+        }
+    }
+
+    // the significant bytes of a[0, n) as count words of size bytes at dst
+    inline void export_words(void* dst, size_t count, const impl_t* a, size_t n, int order, size_t size, int endian){
+        uint8_t* p = static_cast<uint8_t*>(dst);
+        size_t total = count * size, used = min_sz(total, n * impl_t_byte_sz);
+
+        switch(word_layout(order, size, endian)){
+        case 0:
+            std::memcpy(p, a, used);
+            std::fill(p + used, p + total, 0);
+            break;
+        case 1:
+            reverse_bytes(p + total - used, reinterpret_cast<const uint8_t*>(a), used);
+            std::fill(p, p + total - used, 0);
+            break;
+        default:
+            for(size_t k=0; k<total; k++)
+                p[word_byte_offset(k, count, order, size, endian)] = (k < used) ? limb_byte(a, k) : 0;
+        }
+    }
+}
+
 // Constructors
 //
 template<size_t _SZ>
@@ -341,6 +794,10 @@ Signed<_SZ>::Signed(T val){
             if((impl_t)(uval >> sizeof(impl_t)*8*i) != 0){ flags |= TRUNCATED; break; }
         }
     }
+    // the top limb can hold more than _SZ bits, still report values wider than declared
+    if constexpr (_SZ < sizeof(uval)*8){
+        if(uval >> _SZ) flags |= TRUNCATED;
+    }
 }
 
 template<size_t _SZ>
@@ -356,30 +813,34 @@ Signed<_SZ>::Signed(const Signed<SZ>& other){
     }
 }
 
+template<size_t _SZ>
+Signed<_SZ>::Signed(const View& view){
+    assign_segments(view.limbs().data, view.segments_count());
+    set_sign(view.is_negative());
+}
+
 template<size_t _SZ>
 template<typename T>
 bool Signed<_SZ>::import(T * data, size_t count){ 
-    if(sizeof(T) * count > sizeof(impl_t) * segments_count) return false;
+    static_assert(std::is_integral<T>::value);
+    return import(data, count, -1, sizeof(T), 0);
+}
 
-    for(auto s : _segments) s = 0;
+template<size_t _SZ>
+bool Signed<_SZ>::import(const void* data, size_t count, int order, size_t size, int endian){
+    assert((order == 1 || order == -1) && (endian >= -1 && endian <= 1) && size > 0);
+    flags = 0;
+    if(detail::import_words(_segments.data(), segments_count, data, count, order, size, endian)) return true;
+    flags |= TRUNCATED;
+    return false;
+}
 
-    if(sizeof(impl_t) > sizeof(T)){
-        for(size_t i = 0; i < count; i++) {
-            for(size_t j = 0; j < sizeof(impl_t) / sizeof(T); j++) {
-                T dataval = data[i * sizeof(impl_t) / sizeof(T) + j];
-                _segments[i * sizeof(impl_t) / sizeof(T)] += dataval << j * sizeof(T) * 8;
-            }
-        }
-    } else {
-        for(size_t i = 0; i < count; i++) {
-            T dataval = data[i];
-            for(size_t j = 0; j < sizeof(T) / sizeof(impl_t); j++) {
-                _segments[i * sizeof(T) / sizeof(impl_t) + j] =
-                    dataval >> j * sizeof(impl_t) * 8;
-            }
-        }
-    }
-    return true;
+template<size_t _SZ>
+size_t Signed<_SZ>::export_to(void* data, int order, size_t size, int endian) const {
+    assert((order == 1 || order == -1) && (endian >= -1 && endian <= 1) && size > 0);
+    size_t count = export_count(size);
+    detail::export_words(data, count, _segments.data(), segments_count, order, size, endian);
+    return count;
 }
 
 //Assignment
@@ -406,218 +867,1666 @@ inline impl_t Signed<_SZ>::get_segment(size_t index) const {
 
 template<size_t _SZ>
 inline bool Signed<_SZ>::bit_at(size_t index) const {
-    size_t segment_i = floor(index/impl_t_bit_sz);
-    size_t bit_i = index - ( segment_i * impl_t_bit_sz);
-    return (get_segment(segment_i) & (1 << bit_i));
+    return (get_segment(index / impl_t_bit_sz) >> (index % impl_t_bit_sz)) & 1;
 }
 
-//subtract unsigned
-template<size_t SZ1, size_t SZ2> 
-/*static */Signed<std::max(SZ1, SZ2)+1> add_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    constexpr size_t ret_sz = std::max(SZ1, SZ2)+1;
-    Signed<ret_sz> ret = lhs;
+// Carry-chain kernels
+// single pass over little-endian limb ranges, the carry never leaves a register
+namespace detail{
+    inline int cmp(const impl_t* a, size_t an, const impl_t* b, size_t bn){
+        for(; an > bn; an--) if(a[an-1]) return 1;
+        for(; bn > an; bn--) if(b[bn-1]) return -1;
+        for(size_t i = an; i > 0; i--)
+            if(a[i-1] != b[i-1]) return (a[i-1] > b[i-1]) ? 1 : -1;
+        return 0;
+    }
+
+    inline impl_t add_1(impl_t* r, const impl_t* a, size_t n, impl_t b){
+        for(size_t i=0; i<n; i++){
+            r[i] = (impl_t)(a[i] + b);
+            b = (r[i] < b);
+        }
+        return b;
+    }
 
-    std::function<bool(size_t, impl_t)>
-    add_to_segment = [&](size_t index, impl_t val) {
-                         impl_t temp = ret._segments[index];
-                         ret._segments[index] += val;
-                         if(ret._segments[index] < temp) {
-                             if(index == ret.segments_count - 1) //overflow
-                                 return false;
-                             else
-                                 return add_to_segment(index + 1, 1);
-                         }
-                         return true;
-                     };
+    inline impl_t sub_1(impl_t* r, const impl_t* a, size_t n, impl_t b){
+        for(size_t i=0; i<n; i++){
+            impl_t s = a[i];
+            r[i] = (impl_t)(s - b);
+            b = (s < b);
+        }
+        return b;
+    }
 
-    //TODO: signal overflow
-    for(size_t i=0; i < rhs.segments_count; i++)
-        add_to_segment(i, rhs._segments[i]);
+    // a + b + carry, carry is replaced by the carry out
+    inline impl_t addc(impl_t a, impl_t b, unsigned char& carry){
+#if defined(__x86_64__)
+        if constexpr (sizeof(impl_t) == 8){
+            unsigned long long r;
+            carry = _addcarry_u64(carry, a, b, &r);
+            return (impl_t)r;
+        }
+#endif
+        impl_t r;
+        bool c = __builtin_add_overflow(a, b, &r);
+        c |= __builtin_add_overflow(r, (impl_t)carry, &r);
+        carry = c;
+        return r;
+    }
 
-    return ret;
+    // a - b - borrow, borrow is replaced by the borrow out
+    inline impl_t subb(impl_t a, impl_t b, unsigned char& borrow){
+#if defined(__x86_64__)
+        if constexpr (sizeof(impl_t) == 8){
+            unsigned long long r;
+            borrow = _subborrow_u64(borrow, a, b, &r);
+            return (impl_t)r;
+        }
+#endif
+        impl_t r;
+        bool c = __builtin_sub_overflow(a, b, &r);
+        c |= __builtin_sub_overflow(r, (impl_t)borrow, &r);
+        borrow = c;
+        return r;
+    }
+
+    inline impl_t add_n(impl_t* r, const impl_t* a, const impl_t* b, size_t n){
+        unsigned char carry = 0;
+        for(size_t i=0; i<n; i++) r[i] = addc(a[i], b[i], carry);
+        return carry;
+    }
+
+    inline impl_t sub_n(impl_t* r, const impl_t* a, const impl_t* b, size_t n){
+        unsigned char borrow = 0;
+        for(size_t i=0; i<n; i++) r[i] = subb(a[i], b[i], borrow);
+        return borrow;
+    }
+
+    // an >= bn
+    inline impl_t add(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn){
+        impl_t carry = add_n(r, a, b, bn);
+        return add_1(r + bn, a + bn, an - bn, carry);
+    }
+
+    inline impl_t sub(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn){
+        impl_t borrow = sub_n(r, a, b, bn);
+        return sub_1(r + bn, a + bn, an - bn, borrow);
+    }
+
+    // a[0, n) += b[0, bn) in place, the carry stops at the first limb that absorbs it;
+    // true when the sum does not fit in n limbs
+    inline bool add_in_place(impl_t* a, size_t n, const impl_t* b, size_t bn){
+        size_t m = min_sz(n, bn);
+        unsigned char carry = 0;
+        for(size_t i=0; i<m; i++) a[i] = addc(a[i], b[i], carry);
+        for(size_t i=m; carry && i<n; i++) a[i] = addc(a[i], 0, carry);
+        bool lost = carry;
+        for(size_t i=m; !lost && i<bn; i++) lost = (b[i] != 0);
+        return lost;
+    }
+
+    // a[0, n) = |a - b| in place, returns cmp(a, b); lost is set when b is the larger
+    // and the difference does not fit in n limbs
+    inline int sub_in_place(impl_t* a, size_t n, const impl_t* b, size_t bn, bool& lost){
+        size_t m = min_sz(n, bn);
+        unsigned char borrow = 0;
+        int order = cmp(a, n, b, bn);
+        lost = false;
+        if(order >= 0){
+            // limbs of b above m are zero here
+            for(size_t i=0; i<m; i++) a[i] = subb(a[i], b[i], borrow);
+            for(size_t i=m; borrow && i<n; i++) a[i] = subb(a[i], 0, borrow);
+            return order;
+        }
+        // and here limbs of a above m are, so the borrow out of m only reaches b's high limbs
+        for(size_t i=0; i<m; i++) a[i] = subb(b[i], a[i], borrow);
+        for(size_t i=m; !lost && i<bn; i++) lost = (subb(b[i], 0, borrow) != 0);
+        return order;
+    }
+
+    // funnel shifts for s < impl_t_bit_sz: the high limb of hi:lo << s and the low limb
+    // of hi:lo >> s, one shld / shrd on x86-64 and no shift by the full limb width
+    inline impl_t shld(impl_t hi, impl_t lo, unsigned s){
+        return (impl_t)(((((dimpl_t)hi << impl_t_bit_sz) | lo) << (s & (impl_t_bit_sz - 1))) >> impl_t_bit_sz);
+    }
+    inline impl_t shrd(impl_t lo, impl_t hi, unsigned s){
+        return (impl_t)((((dimpl_t)hi << impl_t_bit_sz) | lo) >> (s & (impl_t_bit_sz - 1)));
+    }
+
+    // r[0, n) = a << shift dropping what passes n limbs, a whole limb memmove then one
+    // funnel pass from the top down, so r may be a; true when nonzero bits were dropped
+    inline bool lshift_words(impl_t* r, const impl_t* a, size_t n, size_t shift){
+        size_t q = min_sz(shift / impl_t_bit_sz, n);
+        unsigned s = shift % impl_t_bit_sz;
+        bool lost = false;
+        for(size_t i=n-q; !lost && i<n; i++) lost = (a[i] != 0);
+        if(q < n){
+            if(s && (impl_t)(a[n-q-1] >> (impl_t_bit_sz - s))) lost = true;
+            if(s == 0){
+                if(r + q != a) std::memmove(r + q, a, (n - q) * sizeof(impl_t));
+            } else {
+                for(size_t i=n-1; i>q; i--) r[i] = shld(a[i-q], a[i-q-1], s);
+                r[q] = (impl_t)(a[0] << s);
+            }
+        }
+        std::memset(r, 0, q * sizeof(impl_t));
+        return lost;
+    }
+
+    // r[0, n) = a >> shift, from the bottom up so r may be a
+    inline void rshift_words(impl_t* r, const impl_t* a, size_t n, size_t shift){
+        size_t q = min_sz(shift / impl_t_bit_sz, n);
+        unsigned s = shift % impl_t_bit_sz;
+        if(q < n){
+            if(s == 0){
+                if(r != a + q) std::memmove(r, a + q, (n - q) * sizeof(impl_t));
+            } else {
+                for(size_t i=0; i+q+1<n; i++) r[i] = shrd(a[i+q], a[i+q+1], s);
+                r[n-q-1] = (impl_t)(a[n-1] >> s);
+            }
+        }
+        std::memset(r + n - q, 0, q * sizeof(impl_t));
+    }
 }
 
-//subtract unsigned
+//add unsigned
 template<size_t SZ1, size_t SZ2> 
-Signed<std::max(SZ1,SZ2)+1> sub_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    constexpr size_t ret_sz = std::max(SZ1, SZ2)+1;
+/*static */Signed<max_sz(SZ1, SZ2)+1> add_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    constexpr size_t ret_sz = max_sz(SZ1, SZ2)+1;
+    constexpr size_t n1 = Signed<SZ1>::segments_count;
+    constexpr size_t n2 = Signed<SZ2>::segments_count;
+    constexpr size_t n = max_sz(n1, n2);
     Signed<ret_sz> ret;
-    impl_t carry = 0;
-    impl_t limit = -1;
+    ret.flags = lhs.flags;
 
-    for(size_t i=0; i<ret.segments_count; i++){
-        ret._segments[i] = lhs.get_segment(i) - rhs.get_segment(i) - carry;
-        if  (  ( ret.get_segment(i) > lhs.get_segment(i)) ||
-            ( rhs.get_segment(i) == limit && carry == 1) )
-            { carry = 1; }
-        else{ carry = 0; }
-    }
-    if(carry){ 
-        for(size_t i=0; i<ret.segments_count; i++){ ret._segments[i] = ~ret.get_segment(i); }
-        ret = add_u(ret,Signed<8>(1) );
-        ret.toggle_sign();
+    impl_t carry;
+    if constexpr (n1 >= n2)
+        carry = detail::add(ret._segments.data(), lhs._segments.data(), n1, rhs._segments.data(), n2);
+    else
+        carry = detail::add(ret._segments.data(), rhs._segments.data(), n2, lhs._segments.data(), n1);
+
+    if constexpr (Signed<ret_sz>::segments_count > n) ret._segments[n] = carry;
+    else if(carry) ret.flags |= Signed<ret_sz>::TRUNCATED;
+    return ret;
+}
+
+//subtract unsigned, |lhs| - |rhs| with the sign of the difference
+template<size_t SZ1, size_t SZ2> 
+Signed<max_sz(SZ1,SZ2)+1> sub_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    constexpr size_t ret_sz = max_sz(SZ1, SZ2)+1;
+    constexpr size_t n1 = Signed<SZ1>::segments_count;
+    constexpr size_t n2 = Signed<SZ2>::segments_count;
+    Signed<ret_sz> ret;
+    const impl_t* a = lhs._segments.data();
+    const impl_t* b = rhs._segments.data();
+
+    // subtract the smaller magnitude from the larger, the chain never borrows out,
+    // limbs of the smaller operand above the larger one's count are known zero
+    if(detail::cmp(a, n1, b, n2) < 0){
+        detail::sub(ret._segments.data(), b, n2, a, min_sz(n1, n2));
+        ret.set_sign(true);
+    } else {
+        detail::sub(ret._segments.data(), a, n1, b, min_sz(n1, n2));
     }
     return ret;
 }
 
 //operator+
 template<size_t SZ, typename T>
-inline Signed<std::max(SZ,sizeof(T)*8)+1> operator+(const Signed<SZ>& lhs, T rhs){
+inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator+(const Signed<SZ>& lhs, T rhs){
     return operator+(lhs, Signed<sizeof(T)*8>(rhs));
 }
 
 template<size_t SZ, typename T>
-inline Signed<std::max(SZ,sizeof(T)*8)+1> operator+(T lhs, const Signed<SZ>& rhs){
+inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator+(T lhs, const Signed<SZ>& rhs){
     return operator+(Signed<sizeof(T)*8>(lhs), rhs);
 }
 
 template<size_t SZ1, size_t SZ2>
-inline Signed<std::max(SZ1,SZ2)+1> operator+(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+inline Signed<max_sz(SZ1,SZ2)+1> operator+(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
     if(lhs.sign() == rhs.sign())    { return add_u<SZ1,SZ2>(lhs, rhs);}
     else                            {
         if(rhs.is_negative())         return sub_u<SZ1,SZ2>(lhs, rhs);
-        else                          return sub_u<SZ1,SZ2>(rhs, lhs);
+        else                          return sub_u<SZ2,SZ1>(rhs, lhs);
     }
 }
 
 //operator+=
-//TODO: SFINAE is integral
-//template<size_t SZ, typename T>
-//inline Signed<std::max(SZ,sizeof(T)*8)+1>& operator+=(const Signed<SZ>& lhs, T rhs){
-//    lhs = lhs + rhs;
-//    return lhs;
-//}
-
-// template<size_t SZ, typename T>
-// inline Signed<std::max(SZ,sizeof(T)*8)+1>& operator+=(T lhs, const Signed<SZ>& rhs){
-
-// }
+template<size_t SZ, typename T>
+inline std::enable_if_t<std::is_integral<T>::value, Signed<SZ>&> operator+=(Signed<SZ>& lhs, T rhs){
+    return lhs += Signed<sizeof(T)*8>(rhs);
+}
 
 template<size_t SZ1, size_t SZ2>
 inline Signed<SZ1>& operator+=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    lhs = lhs + rhs;
+    impl_t* a = lhs._segments.data();
+    const impl_t* b = rhs._segments.data();
+    bool lost = false;
+    if(lhs.sign() == rhs.sign()){
+        lost = detail::add_in_place(a, lhs.segments_count, b, rhs.segments_count);
+    } else {
+        // the difference takes the sign of the larger magnitude, zero is positive
+        int order = detail::sub_in_place(a, lhs.segments_count, b, rhs.segments_count, lost);
+        if(order <= 0) lhs.set_sign(order < 0 && rhs.is_negative());
+    }
+    lhs.flags &= ~Signed<SZ1>::TRUNCATED;
+    if(lost) lhs.flags |= Signed<SZ1>::TRUNCATED;
     return lhs;
 }
- 
+
 
 //operator-
 template<size_t SZ, typename T>
-inline Signed<std::max(SZ,sizeof(T)*8)+1> operator-(T lhs, const Signed<SZ>& rhs){
+inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator-(T lhs, const Signed<SZ>& rhs){
     return operator-(Signed<sizeof(T)*8>(lhs), rhs);
 }
 
 template<size_t SZ, typename T>
-inline Signed<std::max(SZ,sizeof(T)*8)+1> operator-(const Signed<SZ>& lhs, T rhs){
+inline Signed<max_sz(SZ,sizeof(T)*8)+1> operator-(const Signed<SZ>& lhs, T rhs){
     return operator-(lhs, Signed<sizeof(T)*8>(rhs));
 }
 template<size_t SZ1, size_t SZ2>
-inline Signed<std::max(SZ1,SZ2)+1> operator-(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    if(lhs.sign() == rhs.sign())    { return sub_u<SZ1,SZ2>(lhs, rhs);}
+inline Signed<max_sz(SZ1,SZ2)+1> operator-(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    if(lhs.sign() == rhs.sign())    {
+        if(lhs.is_negative())         return sub_u<SZ2,SZ1>(rhs, lhs);
+        else                          return sub_u<SZ1,SZ2>(lhs, rhs);
+    }
     else                            { return add_u<SZ1,SZ2>(lhs, rhs);}
 }
 
+//operator-=
+template<size_t SZ, typename T>
+inline std::enable_if_t<std::is_integral<T>::value, Signed<SZ>&> operator-=(Signed<SZ>& lhs, T rhs){
+    return lhs -= Signed<sizeof(T)*8>(rhs);
+}
+
+template<size_t SZ1, size_t SZ2>
+inline Signed<SZ1>& operator-=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    impl_t* a = lhs._segments.data();
+    const impl_t* b = rhs._segments.data();
+    bool lost = false;
+    if(lhs.sign() != rhs.sign()){
+        lost = detail::add_in_place(a, lhs.segments_count, b, rhs.segments_count);
+    } else {
+        int order = detail::sub_in_place(a, lhs.segments_count, b, rhs.segments_count, lost);
+        if(order <= 0) lhs.set_sign(order < 0 && rhs.is_positive());
+    }
+    lhs.flags &= ~Signed<SZ1>::TRUNCATED;
+    if(lost) lhs.flags |= Signed<SZ1>::TRUNCATED;
+    return lhs;
+}
 
-template<typename Iter>
-void fft(Iter first, Iter last, bool inverse = false){
-    size_t size = last - first;
-    if(size >= 2){
-        std::vector<std::complex<double>> temp(size/2);
-        for(size_t i=0; i<size/2; i++){
-            temp [i] = first[i * 2 + 1];
-            first[i] = first[i * 2];
+// Thread pool
+// opt-in parallelism for products whose smaller operand reaches BIGINT_PARALLEL_THRESHOLD
+// limbs; serial until set_threads (or BIGINT_THREADS) asks for more than one thread
+namespace detail{
+    // a deque per worker plus one for outside threads; owners push and pop at the back,
+    // idle threads steal from the front of the others
+    class thread_pool{
+    public:
+        explicit thread_pool(size_t threads) : _queues(threads) {
+            for(size_t i=0; i+1<threads; i++)
+                _workers.emplace_back([this, i]{ work(i); });
+        }
+        ~thread_pool(){
+            { std::lock_guard<std::mutex> lock(_sleep); _stop = true; }
+            _wake.notify_all();
+            for(auto& w : _workers) w.join();
+        }
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        // threads taking part, the caller included
+        size_t size() const { return _queues.size(); }
+
+        void push(std::function<void()> task){
+            auto& q = _queues[slot()];
+            { std::lock_guard<std::mutex> lock(q.m); q.tasks.push_back(std::move(task)); }
+            _pending.fetch_add(1);
+            // taking the lock orders this against a worker checking _pending before it sleeps
+            { std::lock_guard<std::mutex> lock(_sleep); }
+            _wake.notify_one();
         }
-        for(size_t i=0; i<size/2; i++)
-            first[i + size/2] = temp[i];
 
-        auto split = first + size/2;
-        fft(first,split, inverse);
-        fft(split,last, inverse);
-        for(size_t k=0; k<size/2; k++){
-            auto w = std::exp(std::complex<double>(0, (inverse ? -1 : 1) * 2.0 * M_PI * k / size));
-            auto bottom = first[k];
-            auto top = first[k + size/2];
+        // runs one queued task on the calling thread, false when there was none
+        bool try_run_one(){
+            std::function<void()> task;
+            size_t own = slot();
+            if(!pop(_queues[own], task, true)){
+                size_t i = 1;
+                for(; i<_queues.size(); i++)
+                    if(pop(_queues[(own + i) % _queues.size()], task, false)) break;
+                if(i == _queues.size()) return false;
+            }
+            _pending.fetch_sub(1);
+            task();
+            return true;
+        }
 
-            first[k]          = bottom + w * top;
-            first[k + size/2] = bottom - w * top;
+    private:
+        struct queue{
+            std::mutex m;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        static bool pop(queue& q, std::function<void()>& task, bool back){
+            std::lock_guard<std::mutex> lock(q.m);
+            if(q.tasks.empty()) return false;
+            if(back){ task = std::move(q.tasks.back());  q.tasks.pop_back(); }
+            else    { task = std::move(q.tasks.front()); q.tasks.pop_front(); }
+            return true;
         }
-    }
-}
 
+        // workers own queues [0, size-1), everyone else shares the last one
+        static thread_local const thread_pool* _owner;
+        static thread_local size_t _index;
+        size_t slot() const { return (_owner == this) ? _index : _queues.size() - 1; }
+
+        void work(size_t index){
+            _owner = this;
+            _index = index;
+            for(;;){
+                if(try_run_one()) continue;
+                std::unique_lock<std::mutex> lock(_sleep);
+                _wake.wait(lock, [this]{ return _stop || _pending.load() > 0; });
+                if(_stop && _pending.load() == 0) return;
+            }
+        }
 
-template<size_t SZ1, size_t SZ2> 
-Signed<SZ1+SZ2> mul_u(const Signed<SZ1>& lhs, Signed<SZ2> rhs){
+        std::vector<queue> _queues;
+        std::vector<std::thread> _workers;
+        std::atomic<size_t> _pending{0};
+        std::mutex _sleep;
+        std::condition_variable _wake;
+        bool _stop = false;
+    };
+    inline thread_local const thread_pool* thread_pool::_owner = nullptr;
+    inline thread_local size_t thread_pool::_index = 0;
+
+    // tasks forked from one place and joined before their results are read;
+    // without a pool they run on the spot, a waiting thread keeps running queued tasks
+    class task_group{
+    public:
+        explicit task_group(thread_pool* pool) : _pool(pool) {}
+        ~task_group(){ wait(); }
+        task_group(const task_group&) = delete;
+        task_group& operator=(const task_group&) = delete;
+
+        template<typename F>
+        void run(F f){
+            if(!_pool){ f(); return; }
+            _left.fetch_add(1);
+            _pool->push([this, f]{ f(); _left.fetch_sub(1, std::memory_order_release); });
+        }
 
-    constexpr size_t pow2_sz = MSB(Signed<SZ1+SZ2>::segments_count);
+        void wait(){
+            while(_left.load(std::memory_order_acquire))
+                if(!_pool->try_run_one()) std::this_thread::yield();
+        }
 
-    Signed<SZ1+SZ2> ret;
-    std::array<std::complex<double>, pow2_sz> X, Y, Z;
+    private:
+        thread_pool* _pool;
+        std::atomic<size_t> _left{0};
+    };
 
-    for(size_t i=0; i<pow2_sz; i++) X[i] = lhs.get_segment(i);
-    for(size_t i=0; i<pow2_sz; i++) Y[i] = rhs.get_segment(i);
+    // f(lo, hi) over [begin, end) in chunks of at least grain, the last chunk on the caller
+    template<typename F>
+    inline void parallel_for(thread_pool* pool, size_t begin, size_t end, size_t grain, const F& f){
+        size_t len = end - begin;
+        size_t chunks = pool ? std::min(4*pool->size(), len / std::max(grain, (size_t)1)) : 1;
+        if(chunks < 2){ f(begin, end); return; }
+
+        size_t step = (len + chunks - 1) / chunks;
+        task_group group(pool);
+        for(size_t lo = begin; lo < end; lo += step){
+            size_t hi = std::min(end, lo + step);
+            if(hi == end) f(lo, hi);
+            else          group.run([&f, lo, hi]{ f(lo, hi); });
+        }
+        group.wait();
+    }
 
-    [[maybe_unused]] auto pp = [](std::array<std::complex<double>, pow2_sz> A){
-                  for(size_t i=0; i<pow2_sz; i++) std::cout << A[i] << " ";
-                  std::puts("\n");};
+    // a power of two n split into independent blocks for the pool, n itself when serial
+    inline size_t parallel_block(const thread_pool* pool, size_t n, size_t min_block){
+        if(!pool) return n;
+        size_t parts = MSB(4*pool->size() - 1) << 1;
+        return std::max(n / parts, std::min(n, min_block));
+    }
 
-    fft(X.begin(), X.end(), false);
-    fft(Y.begin(), Y.end(), false);
+    struct pool_state{
+        std::mutex m;
+        size_t threads = BIGINT_THREADS ? BIGINT_THREADS : std::max(std::thread::hardware_concurrency(), 1u);
+        std::unique_ptr<thread_pool> pool;
+    };
+    inline pool_state& pool_state_get(){
+        static pool_state state;
+        return state;
+    }
 
-    for(size_t i=0; i<pow2_sz; i++) Z[i] = X[i] * Y[i];
+    // the shared pool for a product whose smaller operand has n limbs, nullptr to stay serial
+    inline thread_pool* parallel_pool(size_t n){
+        if(n < BIGINT_PARALLEL_THRESHOLD) return nullptr;
+        pool_state& s = pool_state_get();
+        std::lock_guard<std::mutex> lock(s.m);
+        if(s.threads < 2) return nullptr;
+        if(!s.pool) s.pool = std::make_unique<thread_pool>(s.threads);
+        return s.pool.get();
+    }
+} // namespace detail
+
+// threads used for products above BIGINT_PARALLEL_THRESHOLD, the caller included;
+// 0 picks std::thread::hardware_concurrency(), 1 keeps everything serial.
+// Must not be called while another thread is multiplying.
+inline void set_threads(size_t n){
+    if(n == 0) n = std::max(std::thread::hardware_concurrency(), 1u);
+    detail::pool_state& s = detail::pool_state_get();
+    std::lock_guard<std::mutex> lock(s.m);
+    if(n != s.threads) s.pool.reset();
+    s.threads = n;
+}
 
-    fft(Z.begin(), Z.end(), true);
+inline size_t threads(){
+    detail::pool_state& s = detail::pool_state_get();
+    std::lock_guard<std::mutex> lock(s.m);
+    return s.threads;
+}
 
-    Signed<pow2_sz * impl_t_bit_sz> temp; 
-    for(size_t i=0; i<pow2_sz; i++) {
-        temp = std::llround(Z[i].real());
-        temp <<= i * impl_t_bit_sz;
-        ret += temp;
+// Multiplication kernels
+// mpn-style routines over raw little-endian limb ranges, shared by all tiers
+namespace detail{
+    // full product of two limbs, high half in hi
+    inline impl_t mul_wide(impl_t a, impl_t b, impl_t& hi){
+        dimpl_t p = (dimpl_t)a * b;
+        hi = (impl_t)(p >> impl_t_bit_sz);
+        return (impl_t)p;
     }
-    ret >>= std::log2(MSB(pow2_sz));
 
-    return ret;
-}
+    // r = |a - b| over an limbs (an >= bn), returns true when a < b
+    inline bool sub_abs(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn){
+        if(cmp(a, an, b, bn) < 0){
+            sub_n(r, b, a, bn);
+            std::fill(r + bn, r + an, 0);
+            return true;
+        }
+        sub(r, a, an, b, bn);
+        return false;
+    }
 
-//template<size_t SZ, typename T>
-//inline Signed<SZ+sizeof(T)*8> operator*(T lhs, const Signed<SZ>& rhs){
-//    return operator*(Signed<sizeof(T)*8>(lhs), rhs);
-//}
-//
-//template<size_t SZ, typename T>
+    inline impl_t addmul_1(impl_t* r, const impl_t* a, size_t n, impl_t b){
+        impl_t carry = 0;
+        for(size_t i=0; i<n; i++){
+            // a*b + r + carry < 2^(2*bits), no overflow of the double limb
+            dimpl_t p = (dimpl_t)a[i] * b + r[i] + carry;
+            r[i] = (impl_t)p;
+            carry = (impl_t)(p >> impl_t_bit_sz);
+        }
+        return carry;
+    }
+
+    inline void rshift1(impl_t* r, const impl_t* a, size_t n){
+        for(size_t i=0; i+1<n; i++)
+            r[i] = (impl_t)((a[i] >> 1) | (a[i+1] << (impl_t_bit_sz-1)));
+        r[n-1] = a[n-1] >> 1;
+    }
+
+    // a must be a multiple of 3
+    inline void divexact_by3(impl_t* r, const impl_t* a, size_t n){
+        constexpr impl_t inv3 = (impl_t)0xAAAAAAAAAAAAAAABull;
+        impl_t borrow = 0;
+        for(size_t i=0; i<n; i++){
+            impl_t s = a[i];
+            impl_t x = (impl_t)(s - borrow);
+            impl_t q = (impl_t)(x * inv3);
+            r[i] = q;
+            borrow = (impl_t)(((dimpl_t)q * 3) >> impl_t_bit_sz) + (s < borrow);
+        }
+    }
+
+    inline void mul_basecase(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn){
+        std::fill(r, r + an + bn, 0);
+        for(size_t j=0; j<bn; j++){
+            if(b[j] == 0) continue;
+            r[j + an] = addmul_1(r + j, a, an, b[j]);
+        }
+    }
+
+    inline impl_t lshift1(impl_t* r, const impl_t* a, size_t n){
+        impl_t out = a[n-1] >> (impl_t_bit_sz-1);
+        for(size_t i=n-1; i>0; i--)
+            r[i] = (impl_t)((a[i] << 1) | (a[i-1] >> (impl_t_bit_sz-1)));
+        r[0] = (impl_t)(a[0] << 1);
+        return out;
+    }
+
+    // each cross product a_i*a_j (i < j) is computed once and doubled
+    inline void sqr_basecase(impl_t* r, const impl_t* a, size_t n){
+        std::fill(r, r + 2*n, 0);
+        for(size_t i=0; i+1<n; i++)
+            r[i + n] = addmul_1(r + 2*i + 1, a + i + 1, n - i - 1, a[i]);
+        lshift1(r, r, 2*n);
+
+        impl_t carry = 0;
+        for(size_t i=0; i<n; i++){
+            dimpl_t sq = (dimpl_t)a[i] * a[i];
+            dimpl_t s = (dimpl_t)r[2*i] + (impl_t)sq + carry;
+            r[2*i] = (impl_t)s;
+            s = (dimpl_t)r[2*i+1] + (impl_t)(sq >> impl_t_bit_sz) + (impl_t)(s >> impl_t_bit_sz);
+            r[2*i+1] = (impl_t)s;
+            carry = (impl_t)(s >> impl_t_bit_sz);
+        }
+    }
+
+    inline size_t mul_n_itch(size_t n){
+        if(n < BIGINT_KARATSUBA_THRESHOLD) return 0;
+        if(n < BIGINT_TOOM3_THRESHOLD){
+            size_t m = (n+1)/2;
+            return 6*m + mul_n_itch(m);
+        }
+        size_t k = (n+2)/3;
+        return 6*(k+1) + 3*(2*k+2) + mul_n_itch(k+1);
+    }
+
+    inline void mul_n(impl_t* r, const impl_t* a, const impl_t* b, size_t n, impl_t* scratch);
+    inline void sqr_n(impl_t* r, const impl_t* a, size_t n, impl_t* scratch);
+
+    // r holds z0 in [0, 2m) and z2 in [2m, 2n), t = |a0-a1||b0-b1|;
+    // adds z1 = z0 + z2 -/+ t at limb m, u is 2m limbs of scratch
+    inline void karatsuba_fold(impl_t* r, size_t n, size_t m, const impl_t* t, impl_t* u, bool neg){
+        impl_t carry = add(u, r, 2*m, r + 2*m, 2*(n - m));
+        if(neg) carry += add_n(u, u, t, 2*m);
+        else    carry -= sub_n(u, u, t, 2*m);
+
+        carry += add_n(r + m, r + m, u, 2*m);
+        add_1(r + 3*m, r + 3*m, 2*n - 3*m, carry);
+    }
+
+    // r[0, 2n) = a * b, splits at m = ceil(n/2)
+    inline void mul_karatsuba_n(impl_t* r, const impl_t* a, const impl_t* b, size_t n, impl_t* scratch){
+        size_t m = (n+1)/2, h = n - m;
+        impl_t* da = scratch;
+        impl_t* db = da + m;
+        impl_t* t  = db + m;
+        impl_t* u  = t + 2*m;
+        impl_t* next = u + 2*m;
+
+        // (a0-a1)(b0-b1) is negative when exactly one difference is
+        bool neg = sub_abs(da, a, m, a + m, h) != sub_abs(db, b, m, b + m, h);
+
+        mul_n(r, a, b, m, next);
+        mul_n(r + 2*m, a + m, b + m, h, next);
+        mul_n(t, da, db, m, next);
+        karatsuba_fold(r, n, m, t, u, neg);
+    }
+
+    // r[0, 2n) = a^2, (a0-a1)^2 is never negative
+    inline void sqr_karatsuba_n(impl_t* r, const impl_t* a, size_t n, impl_t* scratch){
+        size_t m = (n+1)/2, h = n - m;
+        impl_t* da = scratch;
+        impl_t* t  = da + m;
+        impl_t* u  = t + 2*m;
+        impl_t* next = u + 2*m;
+
+        sub_abs(da, a, m, a + m, h);
+        sqr_n(r, a, m, next);
+        sqr_n(r + 2*m, a + m, h, next);
+        sqr_n(t, da, m, next);
+        karatsuba_fold(r, n, m, t, u, false);
+    }
+
+    // values at 1, -1 and 2 of x0 + x1*y + x2*y^2, each k+1 limbs; true when p(-1) < 0
+    inline bool toom3_evaluate(const impl_t* x, size_t k, size_t s, impl_t* e1, impl_t* em1, impl_t* e2){
+        const impl_t *x0 = x, *x1 = x + k, *x2 = x + 2*k;
+        // e2 is scratch for x0 + x2 until p(2) is formed
+        e2[k] = add(e2, x0, k, x2, s);
+        e1[k] = e2[k] + add_n(e1, e2, x1, k);
+        bool neg = sub_abs(em1, e2, k+1, x1, k);
+
+        std::copy(x0, x0 + k, e2);
+        e2[k] = addmul_1(e2, x1, k, 2);
+        impl_t carry = addmul_1(e2, x2, s, 4);
+        add_1(e2 + s, e2 + s, k+1-s, carry);
+        return neg;
+    }
+
+    // r holds v0 in [0, 2k) and vinf in [4k, 2n); v1, vm1, v2 are w = 2k+2 limbs
+    // and are clobbered, neg is the sign of vm1 (Bodrato's sequence)
+    inline void toom3_interpolate(impl_t* r, size_t n, size_t k, impl_t* v1, impl_t* vm1, impl_t* v2, bool neg){
+        size_t s = n - 2*k, w = 2*k + 2;
+        const impl_t* v0   = r;
+        const impl_t* vinf = r + 4*k;
+
+        // v2  <- (v2 - vm1)/3   = c1 + c2 + 3c3 + 5c4
+        // vm1 <- (v1 - vm1)/2   = c1 + c3
+        // v1  <- v1 - v0        = c1 + c2 + c3 + c4
+        // v2  <- (v2 - v1)/2 - 2vinf = c3
+        // v1  <- v1 - vm1 - vinf     = c2
+        // vm1 <- vm1 - v2            = c1
+        if(neg){
+            add_n(v2, v2, vm1, w);
+            add_n(vm1, v1, vm1, w);
+        } else {
+            sub_n(v2, v2, vm1, w);
+            sub_n(vm1, v1, vm1, w);
+        }
+        divexact_by3(v2, v2, w);
+        rshift1(vm1, vm1, w);
+        sub(v1, v1, w, v0, 2*k);
+        sub_n(v2, v2, v1, w);
+        rshift1(v2, v2, w);
+        sub(v2, v2, w, vinf, 2*s);
+        sub(v2, v2, w, vinf, 2*s);
+        sub_n(v1, v1, vm1, w);
+        sub(v1, v1, w, vinf, 2*s);
+        sub_n(vm1, vm1, v2, w);
+
+        // c0 and c4 are already in place
+        std::fill(r + 2*k, r + 4*k, 0);
+        impl_t* coefs[] = { vm1, v1, v2 };
+        for(size_t i=1; i<=3; i++){
+            size_t off = i*k, len = std::min(w, 2*n - off);
+            impl_t carry = add_n(r + off, r + off, coefs[i-1], len);
+            add_1(r + off + len, r + off + len, 2*n - off - len, carry);
+        }
+    }
+
+    // r[0, 2n) = a * b, evaluates at 0, 1, -1, 2, inf
+    inline void mul_toom3_n(impl_t* r, const impl_t* a, const impl_t* b, size_t n, impl_t* scratch){
+        size_t k = (n+2)/3, s = n - 2*k, w = 2*k + 2;
+
+        impl_t* e1a  = scratch;
+        impl_t* e1b  = e1a  + (k+1);
+        impl_t* em1a = e1b  + (k+1);
+        impl_t* em1b = em1a + (k+1);
+        impl_t* e2a  = em1b + (k+1);
+        impl_t* e2b  = e2a  + (k+1);
+        impl_t* v1   = e2b  + (k+1);
+        impl_t* vm1  = v1   + w;
+        impl_t* v2   = vm1  + w;
+        impl_t* next = v2   + w;
+
+        bool neg = toom3_evaluate(a, k, s, e1a, em1a, e2a) != toom3_evaluate(b, k, s, e1b, em1b, e2b);
+
+        mul_n(r, a, b, k, next);
+        mul_n(r + 4*k, a + 2*k, b + 2*k, s, next);
+        mul_n(v1,  e1a,  e1b,  k+1, next);
+        mul_n(vm1, em1a, em1b, k+1, next);
+        mul_n(v2,  e2a,  e2b,  k+1, next);
+        toom3_interpolate(r, n, k, v1, vm1, v2, neg);
+    }
+
+    // r[0, 2n) = a^2, one evaluation and five squarings
+    inline void sqr_toom3_n(impl_t* r, const impl_t* a, size_t n, impl_t* scratch){
+        size_t k = (n+2)/3, s = n - 2*k, w = 2*k + 2;
+
+        impl_t* e1   = scratch;
+        impl_t* em1  = e1   + (k+1);
+        impl_t* e2   = em1  + (k+1);
+        impl_t* v1   = e2   + (k+1);
+        impl_t* vm1  = v1   + w;
+        impl_t* v2   = vm1  + w;
+        impl_t* next = v2   + w;
+
+        toom3_evaluate(a, k, s, e1, em1, e2);
+
+        sqr_n(r, a, k, next);
+        sqr_n(r + 4*k, a + 2*k, s, next);
+        sqr_n(v1,  e1,  k+1, next);
+        sqr_n(vm1, em1, k+1, next);
+        sqr_n(v2,  e2,  k+1, next);
+        toom3_interpolate(r, n, k, v1, vm1, v2, false);
+    }
+
+    inline void mul_n(impl_t* r, const impl_t* a, const impl_t* b, size_t n, impl_t* scratch){
+        if     (n < BIGINT_KARATSUBA_THRESHOLD) mul_basecase(r, a, n, b, n);
+        else if(n < BIGINT_TOOM3_THRESHOLD)     mul_karatsuba_n(r, a, b, n, scratch);
+        else                                    mul_toom3_n(r, a, b, n, scratch);
+    }
+
+    // needs mul_n_itch(n) limbs of scratch
+    inline void sqr_n(impl_t* r, const impl_t* a, size_t n, impl_t* scratch){
+        if     (n < BIGINT_KARATSUBA_THRESHOLD) sqr_basecase(r, a, n);
+        else if(n < BIGINT_TOOM3_THRESHOLD)     sqr_karatsuba_n(r, a, n, scratch);
+        else                                    sqr_toom3_n(r, a, n, scratch);
+    }
+
+    inline size_t mul_itch(size_t bn){ return 4*bn + mul_n_itch(bn); }
+
+    // r[0, an+bn) = a * b, an >= bn; the longer operand is cut into bn sized chunks
+    inline void mul(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn, impl_t* scratch){
+        if(bn < BIGINT_KARATSUBA_THRESHOLD){ mul_basecase(r, a, an, b, bn); return; }
+        if(an == bn){ mul_n(r, a, b, bn, scratch); return; }
+
+        impl_t* t = scratch;
+        scratch += 2*bn;
+        std::fill(r, r + an + bn, 0);
+        for(size_t off=0; off < an; off += bn){
+            size_t len = std::min(bn, an - off);
+            if(len == bn) mul_n(t, a + off, b, bn, scratch);
+            else          mul(t, b, bn, a + off, len, scratch);
+            add(r + off, r + off, an + bn - off, t, len + bn);
+        }
+    }
+
+    // mul_n with the sub-products of each Karatsuba / Toom-3 level forked onto the pool,
+    // every task owns its buffers; serial below BIGINT_PARALLEL_THRESHOLD
+    inline void mul_n_par(impl_t* r, const impl_t* a, const impl_t* b, size_t n, thread_pool* pool){
+        if(!pool || n < BIGINT_PARALLEL_THRESHOLD || n < BIGINT_KARATSUBA_THRESHOLD){
+            std::vector<impl_t> scratch(mul_n_itch(n));
+            mul_n(r, a, b, n, scratch.data());
+            return;
+        }
+
+        task_group group(pool);
+        if(n < BIGINT_TOOM3_THRESHOLD){
+            size_t m = (n+1)/2, h = n - m;
+            std::vector<impl_t> buf(6*m);
+            impl_t *da = buf.data(), *db = da + m, *t = db + m, *u = t + 2*m;
+            bool neg = sub_abs(da, a, m, a + m, h) != sub_abs(db, b, m, b + m, h);
+
+            group.run([=]{ mul_n_par(r, a, b, m, pool); });
+            group.run([=]{ mul_n_par(r + 2*m, a + m, b + m, h, pool); });
+            mul_n_par(t, da, db, m, pool);
+            group.wait();
+            karatsuba_fold(r, n, m, t, u, neg);
+            return;
+        }
+
+        size_t k = (n+2)/3, s = n - 2*k, w = 2*k + 2;
+        std::vector<impl_t> buf(6*(k+1) + 3*w);
+        impl_t *e1a = buf.data(), *e1b = e1a + (k+1), *em1a = e1b + (k+1), *em1b = em1a + (k+1);
+        impl_t *e2a = em1b + (k+1), *e2b = e2a + (k+1), *v1 = e2b + (k+1), *vm1 = v1 + w, *v2 = vm1 + w;
+        bool neg = toom3_evaluate(a, k, s, e1a, em1a, e2a) != toom3_evaluate(b, k, s, e1b, em1b, e2b);
+
+        group.run([=]{ mul_n_par(r, a, b, k, pool); });
+        group.run([=]{ mul_n_par(r + 4*k, a + 2*k, b + 2*k, s, pool); });
+        group.run([=]{ mul_n_par(v1, e1a, e1b, k+1, pool); });
+        group.run([=]{ mul_n_par(vm1, em1a, em1b, k+1, pool); });
+        mul_n_par(v2, e2a, e2b, k+1, pool);
+        group.wait();
+        toom3_interpolate(r, n, k, v1, vm1, v2, neg);
+    }
+
+    inline void sqr_n_par(impl_t* r, const impl_t* a, size_t n, thread_pool* pool){
+        if(!pool || n < BIGINT_PARALLEL_THRESHOLD || n < BIGINT_KARATSUBA_THRESHOLD){
+            std::vector<impl_t> scratch(mul_n_itch(n));
+            sqr_n(r, a, n, scratch.data());
+            return;
+        }
+
+        task_group group(pool);
+        if(n < BIGINT_TOOM3_THRESHOLD){
+            size_t m = (n+1)/2, h = n - m;
+            std::vector<impl_t> buf(5*m);
+            impl_t *da = buf.data(), *t = da + m, *u = t + 2*m;
+            sub_abs(da, a, m, a + m, h);
+
+            group.run([=]{ sqr_n_par(r, a, m, pool); });
+            group.run([=]{ sqr_n_par(r + 2*m, a + m, h, pool); });
+            sqr_n_par(t, da, m, pool);
+            group.wait();
+            karatsuba_fold(r, n, m, t, u, false);
+            return;
+        }
+
+        size_t k = (n+2)/3, s = n - 2*k, w = 2*k + 2;
+        std::vector<impl_t> buf(3*(k+1) + 3*w);
+        impl_t *e1 = buf.data(), *em1 = e1 + (k+1), *e2 = em1 + (k+1);
+        impl_t *v1 = e2 + (k+1), *vm1 = v1 + w, *v2 = vm1 + w;
+        toom3_evaluate(a, k, s, e1, em1, e2);
+
+        group.run([=]{ sqr_n_par(r, a, k, pool); });
+        group.run([=]{ sqr_n_par(r + 4*k, a + 2*k, s, pool); });
+        group.run([=]{ sqr_n_par(v1, e1, k+1, pool); });
+        group.run([=]{ sqr_n_par(vm1, em1, k+1, pool); });
+        sqr_n_par(v2, e2, k+1, pool);
+        group.wait();
+        toom3_interpolate(r, n, k, v1, vm1, v2, false);
+    }
+
+    // mul with the bn sized chunks of the longer operand as separate tasks, an >= bn
+    inline void mul_par(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn, thread_pool* pool){
+        if(an == bn){ mul_n_par(r, a, b, bn, pool); return; }
+        if(!pool || bn < BIGINT_PARALLEL_THRESHOLD){
+            std::vector<impl_t> scratch(mul_itch(bn));
+            mul(r, a, an, b, bn, scratch.data());
+            return;
+        }
+
+        // chunk products overlap their neighbours by bn limbs, even and odd ones are
+        // laid out side by side in two rows and the rows added
+        size_t chunks = (an + bn - 1) / bn, rn = an + bn;
+        std::vector<impl_t> rows(2*rn);
+        {
+            task_group group(pool);
+            for(size_t c=0; c<chunks; c++){
+                size_t off = c*bn, len = std::min(bn, an - off);
+                impl_t* t = rows.data() + (c & 1)*rn + off;
+                auto task = [=]{
+                    if(len == bn) mul_n_par(t, a + off, b, bn, pool);
+                    else          mul_par(t, b, bn, a + off, len, pool);
+                };
+                if(c + 1 < chunks) group.run(task);
+                else               task();
+            }
+        }
+        add_n(r, rows.data(), rows.data() + rn, rn);
+    }
+
+    // Number theoretic transform
+    // exact convolution modulo three primes p = c*2^50 + 1 below 2^62, combined with CRT;
+    // limbs are packed into 64 bit words so products of up to 2^57 words stay exact
+    __extension__ typedef unsigned __int128 u128;
+
+    // arithmetic modulo an odd p < 2^62, Montgomery form with R = 2^64
+    struct mod64{
+        uint64_t p, pinv, r2;
+
+        constexpr mod64(uint64_t p_) : p(p_), pinv(0), r2(0){
+            uint64_t inv = p;                       // Newton iteration for p^-1 mod 2^64
+            for(int i=0; i<5; i++) inv *= 2 - p * inv;
+            pinv = 0 - inv;
+            uint64_t r = (0 - p) % p;
+            r2 = (uint64_t)((u128)r * r % p);
+        }
+        constexpr uint64_t mul(uint64_t a, uint64_t b) const { // a * b / R
+            u128 t = (u128)a * b;
+            uint64_t m = (uint64_t)t * pinv;
+            uint64_t u = (uint64_t)((t + (u128)m * p) >> 64);
+            return (u >= p) ? u - p : u;
+        }
+        constexpr uint64_t add(uint64_t a, uint64_t b) const { uint64_t s = a + b; return (s >= p) ? s - p : s; }
+        constexpr uint64_t sub(uint64_t a, uint64_t b) const { return (a >= b) ? a - b : a + p - b; }
+        constexpr uint64_t to(uint64_t a) const { return mul(a % p, r2); }
+        constexpr uint64_t pow(uint64_t a, uint64_t e) const { // Montgomery form in and out
+            uint64_t ret = to(1);
+            for(; e; e >>= 1, a = mul(a, a)) if(e & 1) ret = mul(ret, a);
+            return ret;
+        }
+    };
+
+    struct ntt_prime{ uint64_t p, g; };
+    constexpr ntt_prime ntt_primes[3] = {
+        { 0x3fdc000000000001ull, 3  },
+        { 0x3f18000000000001ull, 10 },
+        { 0x3ec4000000000001ull, 37 }
+    };
+    constexpr size_t ntt_max_log2 = 50;
+    constexpr size_t ntt_word_limbs = 64 / impl_t_bit_sz;
+
+    // tw[len + j] = w_2len^j, itw[len + j] = w_2len^-j, both in Montgomery form
+    inline void ntt_twiddles(uint64_t* tw, uint64_t* itw, size_t n, const mod64& m, uint64_t g){
+        for(size_t len = 1; len < n; len <<= 1){
+            uint64_t w  = m.pow(m.to(g), (m.p - 1) / (2*len));
+            uint64_t iw = m.pow(w, m.p - 2);
+            tw[len] = itw[len] = m.to(1);
+            for(size_t j=1; j<len; j++){
+                tw[len+j]  = m.mul(tw[len+j-1], w);
+                itw[len+j] = m.mul(itw[len+j-1], iw);
+            }
+        }
+    }
+
+    // decimation in frequency, natural order in, bit reversed order out
+    inline void ntt_dif(uint64_t* a, size_t n, const uint64_t* tw, const mod64& m){
+        for(size_t len = n/2; len >= 1; len >>= 1)
+            for(size_t i=0; i<n; i += 2*len)
+                for(size_t j=0; j<len; j++){
+                    uint64_t u = a[i+j], v = a[i+j+len];
+                    a[i+j]     = m.add(u, v);
+                    a[i+j+len] = m.mul(m.sub(u, v), tw[len+j]);
+                }
+    }
+
+    // decimation in time, bit reversed order in, natural order out
+    inline void ntt_dit(uint64_t* a, size_t n, const uint64_t* itw, const mod64& m){
+        for(size_t len = 1; len < n; len <<= 1)
+            for(size_t i=0; i<n; i += 2*len)
+                for(size_t j=0; j<len; j++){
+                    uint64_t u = a[i+j], v = m.mul(a[i+j+len], itw[len+j]);
+                    a[i+j]     = m.add(u, v);
+                    a[i+j+len] = m.sub(u, v);
+                }
+    }
+
+    // butterflies [lo, hi) of the n/2 in one stage, for the stages whose
+    // blocks of 2*len are too few to hand out whole
+    inline void ntt_dif_stage(uint64_t* a, size_t len, size_t lo, size_t hi, const uint64_t* tw, const mod64& m){
+        for(size_t q = lo; q < hi; ){
+            size_t i = q / len * 2*len, j = q % len, end = std::min(len, j + hi - q);
+            q += end - j;
+            for(; j<end; j++){
+                uint64_t u = a[i+j], v = a[i+j+len];
+                a[i+j]     = m.add(u, v);
+                a[i+j+len] = m.mul(m.sub(u, v), tw[len+j]);
+            }
+        }
+    }
+
+    inline void ntt_dit_stage(uint64_t* a, size_t len, size_t lo, size_t hi, const uint64_t* itw, const mod64& m){
+        for(size_t q = lo; q < hi; ){
+            size_t i = q / len * 2*len, j = q % len, end = std::min(len, j + hi - q);
+            q += end - j;
+            for(; j<end; j++){
+                uint64_t u = a[i+j], v = m.mul(a[i+j+len], itw[len+j]);
+                a[i+j]     = m.add(u, v);
+                a[i+j+len] = m.sub(u, v);
+            }
+        }
+    }
+
+    constexpr size_t ntt_grain = 4096;
+
+    // the wide stages split by butterflies, then each block finishes on its own;
+    // tw[len + j] does not depend on the transform size so blocks reuse it
+    inline void ntt_dif_par(uint64_t* a, size_t n, const uint64_t* tw, const mod64& m, thread_pool* pool){
+        size_t block = parallel_block(pool, n, ntt_grain);
+        for(size_t len = n/2; 2*len > block; len >>= 1)
+            parallel_for(pool, 0, n/2, ntt_grain, [&](size_t lo, size_t hi){ ntt_dif_stage(a, len, lo, hi, tw, m); });
+        parallel_for(pool, 0, n/block, 1, [&](size_t lo, size_t hi){
+            for(size_t k=lo; k<hi; k++) ntt_dif(a + k*block, block, tw, m);
+        });
+    }
+
+    inline void ntt_dit_par(uint64_t* a, size_t n, const uint64_t* itw, const mod64& m, thread_pool* pool){
+        size_t block = parallel_block(pool, n, ntt_grain);
+        parallel_for(pool, 0, n/block, 1, [&](size_t lo, size_t hi){
+            for(size_t k=lo; k<hi; k++) ntt_dit(a + k*block, block, itw, m);
+        });
+        for(size_t len = block; len < n; len <<= 1)
+            parallel_for(pool, 0, n/2, ntt_grain, [&](size_t lo, size_t hi){ ntt_dit_stage(a, len, lo, hi, itw, m); });
+    }
+
+    // words [lo, hi) of the transform input, limbs packed ntt_word_limbs to a word
+    inline void ntt_load(uint64_t* x, size_t lo, size_t hi, const impl_t* a, size_t an, const mod64& m){
+        for(size_t i=lo; i<hi; i++){
+            uint64_t word = 0;
+            for(size_t j=0; j<ntt_word_limbs && i*ntt_word_limbs + j < an; j++)
+                word |= (uint64_t)a[i*ntt_word_limbs + j] << (j * impl_t_bit_sz);
+            x[i] = word % m.p;
+        }
+    }
+
+    // r[0, an+bn) = a * b, squaring (a == b) needs only one forward transform;
+    // with a pool both forward transforms run at once and every stage is split
+    inline void mul_ntt(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn, thread_pool* pool = nullptr){
+        bool square = (a == b && an == bn);
+        size_t words = (an + ntt_word_limbs - 1) / ntt_word_limbs
+                     + (bn + ntt_word_limbs - 1) / ntt_word_limbs;
+        size_t n = 2;
+        while(n < words) n <<= 1;
+        assert(n <= ((size_t)1 << ntt_max_log2));
+
+        // working buffer: two transforms, twiddles and one residue vector per prime
+        std::vector<uint64_t> work(7*n);
+        uint64_t *x = work.data(), *y = x + n, *tw = y + n, *itw = tw + n, *res = itw + n;
+
+        for(size_t k=0; k<3; k++){
+            const mod64 m(ntt_primes[k].p);
+            ntt_twiddles(tw, itw, n, m, ntt_primes[k].g);
+            auto forward = [&](uint64_t* t, const impl_t* c, size_t cn){
+                parallel_for(pool, 0, n, ntt_grain, [&](size_t lo, size_t hi){ ntt_load(t, lo, hi, c, cn, m); });
+                ntt_dif_par(t, n, tw, m, pool);
+            };
+            {
+                task_group group(pool);
+                if(!square) group.run([&]{ forward(y, b, bn); });
+                forward(x, a, an);
+            }
+            const uint64_t* yy = square ? x : y;
+
+            // x*y/R from the product, n^-1 * R^2 undoes that and the transform scale
+            uint64_t scale = m.to(m.to(m.p - (m.p - 1) / n));
+            parallel_for(pool, 0, n, ntt_grain, [&](size_t lo, size_t hi){
+                for(size_t i=lo; i<hi; i++) x[i] = m.mul(m.mul(x[i], yy[i]), scale);
+            });
+
+            ntt_dit_par(x, n, itw, m, pool);
+            std::copy(x, x + n, res + k*n);
+        }
+
+        // Garner: c = x0 + p0*t1 + p0*p1*t2, folded into a running 192 bit carry
+        constexpr mod64 m1(ntt_primes[1].p), m2(ntt_primes[2].p);
+        constexpr uint64_t p0 = ntt_primes[0].p;
+        constexpr u128 p01 = (u128)p0 * ntt_primes[1].p;
+        constexpr uint64_t inv_p0_m1  = m1.pow(m1.to(p0), m1.p - 2);
+        constexpr uint64_t p0_m2      = m2.to(p0);
+        constexpr uint64_t inv_p01_m2 = m2.pow(m2.to((uint64_t)(p01 % m2.p)), m2.p - 2);
+
+        uint64_t c0 = 0, c1 = 0, c2 = 0;
+        size_t rn = an + bn;
+        for(size_t i=0; i<n && i*ntt_word_limbs < rn; i++){
+            uint64_t x0 = res[i], x1 = res[n+i], x2 = res[2*n+i];
+            uint64_t t1 = m1.mul(m1.sub(x1, x0 % m1.p), inv_p0_m1);
+            u128 x01 = (u128)p0 * t1 + x0;
+            uint64_t x01_m2 = m2.add(x0 % m2.p, m2.mul(t1 % m2.p, p0_m2));
+            uint64_t t2 = m2.mul(m2.sub(x2, x01_m2), inv_p01_m2);
+
+            u128 lo = (u128)(uint64_t)p01 * t2;
+            u128 hi = (u128)(uint64_t)(p01 >> 64) * t2 + (uint64_t)(lo >> 64);
+            u128 s = (u128)c0 + (uint64_t)lo + (uint64_t)x01;
+            c0 = (uint64_t)s;
+            s = (u128)c1 + (uint64_t)hi + (uint64_t)(x01 >> 64) + (uint64_t)(s >> 64);
+            c1 = (uint64_t)s;
+            c2 += (uint64_t)(hi >> 64) + (uint64_t)(s >> 64);
+
+            for(size_t j=0; j<ntt_word_limbs && i*ntt_word_limbs + j < rn; j++)
+                r[i*ntt_word_limbs + j] = (impl_t)(c0 >> (j * impl_t_bit_sz));
+            c0 = c1; c1 = c2; c2 = 0;
+        }
+    }
+
+    // runtime tier choice for operands whose size is only known at run time, an >= bn
+    inline void mul_any(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn){
+        thread_pool* pool = parallel_pool(bn);
+        if(bn >= BIGINT_NTT_THRESHOLD){ mul_ntt(r, a, an, b, bn, pool); return; }
+        if(bn < BIGINT_KARATSUBA_THRESHOLD){ mul_basecase(r, a, an, b, bn); return; }
+        mul_par(r, a, an, b, bn, pool);
+    }
+
+    inline void sqr_any(impl_t* r, const impl_t* a, size_t n){
+        thread_pool* pool = parallel_pool(n);
+        if(n >= BIGINT_NTT_THRESHOLD){ mul_ntt(r, a, n, a, n, pool); return; }
+        if(n < BIGINT_KARATSUBA_THRESHOLD){ sqr_basecase(r, a, n); return; }
+        sqr_n_par(r, a, n, pool);
+    }
+} // namespace detail
+
+namespace detail{
+    // twiddles for transforms up to size n, tw[len + j] = exp(2*pi*i * j / (2*len));
+    // built once per size and shared by every later transform of that size
+    inline const std::complex<double>* fft_twiddles(size_t n){
+        static std::unique_ptr<std::complex<double>[]> tables[64];
+        static std::once_flag built[64];
+        size_t log2_n = __builtin_ctzll(n);
+        std::call_once(built[log2_n], [&]{
+            auto tw = std::make_unique<std::complex<double>[]>(n);
+            for(size_t len = 1; len < n; len <<= 1)
+                for(size_t j=0; j<len; j++)
+                    tw[len + j] = std::polar(1.0, M_PI * j / len);
+            tables[log2_n] = std::move(tw);
+        });
+        return tables[log2_n].get();
+    }
+
+    inline void bit_reverse(std::complex<double>* a, size_t n){
+        for(size_t i=1, j=0; i<n; i++){
+            size_t bit = n >> 1;
+            for(; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if(i < j) std::swap(a[i], a[j]);
+        }
+    }
+
+    // butterfly groups [lo, hi) of the n/4 in the radix-4 pass at len
+    inline void fft_radix4(std::complex<double>* a, size_t len, size_t lo, size_t hi,
+                           const std::complex<double>* tw, bool inverse){
+        const std::complex<double> quarter(0, inverse ? -1 : 1);
+        auto w_at = [&](size_t k){ return inverse ? std::conj(tw[k]) : tw[k]; };
+
+        for(size_t q = lo; q < hi; ){
+            size_t i = q / len * 4*len, j = q % len, end = std::min(len, j + hi - q);
+            q += end - j;
+            for(; j<end; j++){
+                auto w1 = w_at(len + j), w2 = w_at(2*len + j);
+                auto a1 = w1 * a[i+j+len], a3 = w1 * a[i+j+3*len];
+                auto b0 = a[i+j] + a1,        b1 = a[i+j] - a1;
+                auto b2 = w2 * (a[i+j+2*len] + a3);
+                auto b3 = w2 * quarter * (a[i+j+2*len] - a3);
+                a[i+j]       = b0 + b2; a[i+j+2*len] = b0 - b2;
+                a[i+j+len]   = b1 + b3; a[i+j+3*len] = b1 - b3;
+            }
+        }
+    }
+
+    // the passes of a size n transform that stay inside a block of b elements,
+    // returns the len the next pass starts from
+    inline size_t fft_block(std::complex<double>* a, size_t n, size_t b,
+                            const std::complex<double>* tw, bool inverse){
+        size_t len = 1;
+        if(__builtin_ctzll(n) & 1){
+            for(size_t i=0; i<b; i += 2){
+                auto u = a[i], v = a[i+1];
+                a[i] = u + v; a[i+1] = u - v;
+            }
+            len = 2;
+        }
+        for(; 4*len <= b; len <<= 2) fft_radix4(a, len, 0, b/4, tw, inverse);
+        return len;
+    }
+
+    // in place, unnormalized, n a power of two; the inverse uses conjugate twiddles.
+    // bit reversal followed by decimation in time, two radix-2 stages per radix-4 pass;
+    // with a pool the blocks run their first passes apart and the rest is split by groups
+    inline void fft(std::complex<double>* a, size_t n, bool inverse, thread_pool* pool = nullptr){
+        if(n < 2) return;
+        const std::complex<double>* tw = fft_twiddles(n);
+
+        bit_reverse(a, n);
+        size_t block = parallel_block(pool, n, 4096), len = 0;
+        parallel_for(pool, 0, n/block, 1, [&](size_t lo, size_t hi){
+            for(size_t k=lo; k<hi; k++){
+                size_t next = fft_block(a + k*block, n, block, tw, inverse);
+                if(k == 0) len = next;
+            }
+        });
+        for(; len < n; len <<= 2)
+            parallel_for(pool, 0, n/4, 1024, [&](size_t lo, size_t hi){ fft_radix4(a, len, lo, hi, tw, inverse); });
+    }
+} // namespace detail
+
+template<typename Iter>
+void fft(Iter first, Iter last, bool inverse = false){
+    detail::fft(&*first, last - first, inverse);
+}
+
+namespace detail{
+    constexpr size_t ceil_log2(size_t n){
+        size_t lg = 0;
+        while(((size_t)1 << lg) < n) lg++;
+        return lg;
+    }
+
+    // widest chunk for a 2^lg point transform. The exact coefficients are below
+    // 2^(lg + 2*bits) and the rounding error of the double FFT is that times at most
+    // 3*lg*(1+sqrt 5 + twiddle error)*2^-53 (Percival 2003); one more bit covers packing
+    // both operands into one transform, so every coefficient ends within 1/2 of its integer
+    constexpr size_t fft_chunk_bits(size_t lg){
+        return (51 - lg - ceil_log2(13 * max_sz(lg, 1))) / 2;
+    }
+
+    struct fft_plan{
+        size_t bits;
+        size_t lg;
+    };
+
+    // the widest chunks whose transform length still keeps them under fft_chunk_bits
+    constexpr fft_plan fft_plan_for(size_t abits, size_t bbits){
+        for(size_t bits = 32; bits > 1; bits--){
+            size_t chunks = (abits + bits - 1) / bits + (bbits + bits - 1) / bits - 1;
+            size_t lg = max_sz(ceil_log2(chunks), 1);
+            if(bits <= fft_chunk_bits(lg)) return { bits, lg };
+        }
+        return { 1, ceil_log2(abits + bbits) };
+    }
+
+    // count <= 32 bits of a[0, n) from bit offset on, zeros past the end
+    inline uint64_t fft_chunk(const impl_t* a, size_t n, size_t offset, size_t count){
+        uint64_t v = 0;
+        for(size_t got = 0; got < count;){
+            size_t i = (offset + got) / impl_t_bit_sz, s = (offset + got) % impl_t_bit_sz;
+            if(i >= n) break;
+            v |= (uint64_t)(a[i] >> s) << got;
+            got += impl_t_bit_sz - s;
+        }
+        return v & ((1ull << count) - 1);
+    }
+
+    // ors the count low bits of v into r[0, n) from bit offset on
+    inline void fft_deposit(impl_t* r, size_t n, size_t offset, uint64_t v, size_t count){
+        for(size_t put = 0; put < count;){
+            size_t i = (offset + put) / impl_t_bit_sz, s = (offset + put) % impl_t_bit_sz;
+            if(i >= n) return;
+            r[i] |= (impl_t)((v >> put) << s);
+            put += impl_t_bit_sz - s;
+        }
+    }
+}
+
+template<size_t SZ1, size_t SZ2> 
+Signed<SZ1+SZ2> mul_fft(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    constexpr size_t n1 = Signed<SZ1>::segments_count;
+    constexpr size_t n2 = Signed<SZ2>::segments_count;
+    constexpr size_t n = Signed<SZ1+SZ2>::segments_count;
+
+    // operands are cut into chunks as wide as the transform length allows, see fft_chunk_bits
+    constexpr detail::fft_plan plan = detail::fft_plan_for(n1 * impl_t_bit_sz, n2 * impl_t_bit_sz);
+    constexpr size_t bits = plan.bits;
+    constexpr size_t pow2_sz = (size_t)1 << plan.lg;
+    constexpr uint64_t chunk_mask = (1ull << bits) - 1;
+
+    const impl_t* a = lhs._segments.data();
+    const impl_t* b = rhs._segments.data();
+    bool square = ((const void*)&lhs == (const void*)&rhs);
+    detail::thread_pool* pool = detail::parallel_pool(min_sz(n1, n2));
+
+    // one forward transform for both operands, lhs in the real parts and rhs in the
+    // imaginary ones; transforms are far above any sane stack size, always on the heap
+    std::vector<std::complex<double>> Z(pow2_sz);
+    detail::parallel_for(pool, 0, pow2_sz, 4096, [&](size_t lo, size_t hi){
+        for(size_t i=lo; i<hi; i++)
+            Z[i] = { (double)detail::fft_chunk(a, n1, i * bits, bits),
+                     square ? 0.0 : (double)detail::fft_chunk(b, n2, i * bits, bits) };
+    });
+    detail::fft(Z.data(), pow2_sz, false, pool);
+
+    // with X, Y the transforms of lhs and rhs, X_k = (Z_k + conj Z_-k) / 2 and
+    // Y_k = (Z_k - conj Z_-k) / 2i, so X_k Y_k = (Z_k^2 - conj(Z_-k)^2) / 4i;
+    // k and -k are done together to stay in place
+    detail::parallel_for(pool, 0, pow2_sz/2 + 1, 4096, [&](size_t lo, size_t hi){
+        const std::complex<double> quarter_i(0, -0.25);
+        for(size_t k=lo; k<hi; k++){
+            size_t j = (pow2_sz - k) & (pow2_sz - 1);
+            std::complex<double> zk = Z[k], zj = Z[j];
+            if(square){
+                Z[k] = zk * zk;
+                Z[j] = zj * zj;
+            } else {
+                std::complex<double> ck = std::conj(zk), cj = std::conj(zj);
+                Z[k] = (zk * zk - cj * cj) * quarter_i;
+                Z[j] = (zj * zj - ck * ck) * quarter_i;
+            }
+        }
+    });
+
+    // the product is real, so the inverse runs at half length: with A_k = P_k + P_k+N/2
+    // and B_k = (P_k - P_k+N/2) w^-k, the N/2 point inverse of A + iB holds the even
+    // coefficients in its real parts and the odd ones in its imaginary parts
+    constexpr size_t half = pow2_sz / 2;
+    const std::complex<double>* tw = detail::fft_twiddles(pow2_sz);
+    detail::parallel_for(pool, 0, half, 4096, [&](size_t lo, size_t hi){
+        for(size_t k=lo; k<hi; k++){
+            std::complex<double> u = Z[k], v = Z[k + half];
+            Z[k] = (u + v) + std::complex<double>(0, 1) * ((u - v) * std::conj(tw[half + k]));
+        }
+    });
+    detail::fft(Z.data(), half, true, pool);
+
+    // one pass up the coefficients: the 1/pow2_sz of the unnormalized inverse is folded
+    // into the rounding (a power of two, exact) and the carry runs into the next chunk.
+    // Coefficients are below 2^53, the carry stays in 64 bits
+    const double scale = 1.0 / pow2_sz;
+    Signed<SZ1+SZ2> ret;
+    uint64_t carry = 0;
+    double error = 0;
+    for(size_t i=0; i < pow2_sz && i * bits < n * impl_t_bit_sz; i++){
+        double c = ((i & 1) ? Z[i/2].imag() : Z[i/2].real()) * scale;
+        double rounded = std::nearbyint(c);
+        error = std::max(error, std::fabs(c - rounded));
+        carry += (uint64_t)std::max(rounded, 0.0);
+        detail::fft_deposit(ret._segments.data(), n, i * bits, carry & chunk_mask, bits);
+        carry >>= bits;
+    }
+    ret.multiplication_error_bound = error;
+    return ret;
+}
+
+// picks the algorithm from the operand sizes at compile time:
+// schoolbook, then Karatsuba / Toom-3 (chosen per recursion level), then FFT,
+// and the exact NTT above BIGINT_NTT_THRESHOLD; every tier but schoolbook forks
+// onto the thread pool above BIGINT_PARALLEL_THRESHOLD once set_threads allows it
+template<size_t SZ1, size_t SZ2> 
+Signed<SZ1+SZ2> mul_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    constexpr size_t n1 = Signed<SZ1>::segments_count;
+    constexpr size_t n2 = Signed<SZ2>::segments_count;
+
+    if constexpr (min_sz(n1, n2) < BIGINT_NTT_THRESHOLD && min_sz(n1, n2) >= BIGINT_FFT_THRESHOLD){
+        return mul_fft(lhs, rhs);
+    } else {
+        Signed<SZ1+SZ2> ret;
+        detail::limb_array<n1 + n2> prod;
+
+        if constexpr (min_sz(n1, n2) >= BIGINT_NTT_THRESHOLD){
+            detail::mul_ntt(prod.data(), lhs._segments.data(), n1, rhs._segments.data(), n2,
+                            detail::parallel_pool(min_sz(n1, n2)));
+        } else if constexpr (min_sz(n1, n2) < BIGINT_KARATSUBA_THRESHOLD){
+            detail::mul_basecase(prod.data(), lhs._segments.data(), n1, rhs._segments.data(), n2);
+        } else {
+            detail::thread_pool* pool = detail::parallel_pool(min_sz(n1, n2));
+            if constexpr (n1 >= n2)
+                detail::mul_par(prod.data(), lhs._segments.data(), n1, rhs._segments.data(), n2, pool);
+            else
+                detail::mul_par(prod.data(), rhs._segments.data(), n2, lhs._segments.data(), n1, pool);
+        }
+
+        ret.assign_segments(prod.data(), n1 + n2);
+        return ret;
+    }
+}
+
+template<size_t SZ> 
+Signed<2*SZ> sqr_u(const Signed<SZ>& x){
+    constexpr size_t n = Signed<SZ>::segments_count;
+
+    if constexpr (n < BIGINT_NTT_THRESHOLD && n >= BIGINT_FFT_THRESHOLD){
+        return mul_fft(x, x);
+    } else {
+        Signed<2*SZ> ret;
+        detail::limb_array<2*n> prod;
+
+        if constexpr (n >= BIGINT_NTT_THRESHOLD){
+            detail::mul_ntt(prod.data(), x._segments.data(), n, x._segments.data(), n, detail::parallel_pool(n));
+        } else if constexpr (n < BIGINT_KARATSUBA_THRESHOLD){
+            detail::sqr_basecase(prod.data(), x._segments.data(), n);
+        } else {
+            detail::sqr_n_par(prod.data(), x._segments.data(), n, detail::parallel_pool(n));
+        }
+
+        ret.assign_segments(prod.data(), 2*n);
+        return ret;
+    }
+}
+
+template<size_t SZ>
+inline Signed<2*SZ> square(const Signed<SZ>& x){
+    return sqr_u(x);
+}
+
+//template<size_t SZ, typename T>
+//inline Signed<SZ+sizeof(T)*8> operator*(T lhs, const Signed<SZ>& rhs){
+//    return operator*(Signed<sizeof(T)*8>(lhs), rhs);
+//}
+//
+//template<size_t SZ, typename T>
 //inline Signed<SZ+sizeof(T)*8> operator*(const Signed<SZ>& lhs, T rhs){
 //    return operator*(lhs, Signed<sizeof(T)*8>(rhs));
 //}
 template<size_t SZ1, size_t SZ2>
 inline Signed<SZ1+SZ2> operator*(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    //FIXME
-    //ret.set_sign(lhs.sign() xor rhs.sign());
-
+    if constexpr (SZ1 == SZ2){
+        if(&lhs == &rhs) return square(lhs);
+    }
     Signed<SZ1+SZ2> ret = mul_u(lhs,rhs);
-
+    ret.set_sign(lhs.sign() != rhs.sign());
     return ret;
 }
 
-// template<size_t SZ1, size_t SZ2> 
-// Signed<SZ1+SZ2> div_u(const Signed<SZ1>& lhs, Signed<SZ2> rhs){
-//    Signed<SZ1+SZ2> ret;
-//    auto diff = lhs.get_segments_count() - rhs.get_segments_count();
-//    for(size_t i=0; i<diff; i++){
+namespace detail{
+    // a[0, n) *= b[0, bn) keeping the low n limbs; rows go from the top limb of a down,
+    // so each one reads a limb that no earlier row has written. True when the product
+    // does not fit in n limbs
+    inline bool mul_in_place(impl_t* a, size_t n, const impl_t* b, size_t bn){
+        while(bn && !b[bn-1]) bn--;
+        bool lost = false;
+        for(size_t i=n; i-- > 0;){
+            impl_t t = a[i];
+            a[i] = 0;
+            if(!t) continue;
+            size_t len = min_sz(bn, n - i);
+            impl_t c = addmul_1(a + i, b, len, t);
+            // with b[bn-1] != 0 a cut row always has a nonzero part above n
+            if(len < bn) lost = true;
+            for(size_t j=i+len; c && j<n; j++){ a[j] = (impl_t)(a[j] + c); c = (a[j] < c); }
+            if(c) lost = true;
+        }
+        return lost;
+    }
+}
+
+//operator*=
+template<size_t SZ, typename T>
+inline std::enable_if_t<std::is_integral<T>::value, Signed<SZ>&> operator*=(Signed<SZ>& lhs, T rhs){
+    return lhs *= Signed<sizeof(T)*8>(rhs);
+}
 
-//    }
-//    return ret;
-// }
+template<size_t SZ1, size_t SZ2>
+inline Signed<SZ1>& operator*=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    // rows cost n1*n2, past the Karatsuba crossover the full product is cheaper
+    constexpr bool rows = min_sz(Signed<SZ1>::segments_count, Signed<SZ2>::segments_count) < BIGINT_KARATSUBA_THRESHOLD;
+    if(!rows || (const void*)&lhs == (const void*)&rhs){
+        lhs = lhs * rhs;
+        return lhs;
+    }
+    bool negative = lhs.sign() != rhs.sign();
+    bool lost = detail::mul_in_place(lhs._segments.data(), lhs.segments_count, rhs._segments.data(), rhs.segments_count);
+    lhs.flags &= ~Signed<SZ1>::TRUNCATED;
+    if(lost) lhs.flags |= Signed<SZ1>::TRUNCATED;
+    lhs.set_sign(negative);
+    return lhs;
+}
 
-// template<size_t SZ1, size_t SZ2>
-// inline Signed<SZ1+SZ2> operator/(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-// }
+// Division kernels
+// normalized Knuth Algorithm D, the 2/1 steps use a precomputed reciprocal
+// (Moller, Granlund: Improved division by invariant integers)
+namespace detail{
+    // floor((B^2 - 1) / d) - B for a normalized d
+    inline impl_t invert_limb(impl_t d){
+        return (impl_t)(((dimpl_t)(impl_t)~d << impl_t_bit_sz | (impl_t)~(impl_t)0) / d);
+    }
 
+    // <u1, u0> / d for a normalized d and u1 < d, remainder in r
+    inline impl_t div_2by1(impl_t& r, impl_t u1, impl_t u0, impl_t d, impl_t v){
+        dimpl_t qq = (dimpl_t)((dimpl_t)v * u1 + ((dimpl_t)u1 << impl_t_bit_sz | u0));
+        impl_t q1 = (impl_t)((qq >> impl_t_bit_sz) + 1);
+        impl_t q0 = (impl_t)qq;
+        impl_t rr = (impl_t)(u0 - (impl_t)(q1 * d));
+        if(rr > q0){ q1--; rr = (impl_t)(rr + d); }
+        if(rr >= d){ q1++; rr = (impl_t)(rr - d); }
+        r = rr;
+        return q1;
+    }
 
+    // r[0, n) = a << cnt, cnt < impl_t_bit_sz, returns the bits shifted out
+    inline impl_t lshift(impl_t* r, const impl_t* a, size_t n, unsigned cnt){
+        if(cnt == 0){ std::copy(a, a + n, r); return 0; }
+        impl_t out = shld(0, a[n-1], cnt);
+        for(size_t i=n-1; i>0; i--) r[i] = shld(a[i], a[i-1], cnt);
+        r[0] = (impl_t)(a[0] << cnt);
+        return out;
+    }
 
-//template<size_t SZ1, size_t SZ2> // take two unsinged
-//static Signed<SZ1+SZ2> div_u(const Signed<SZ1>& lhs, Signed<SZ2> rhs){
-//    if(lhs == rhs) return Signed<8>::ONE;
-//    if(lhs <  rhs) return Signed<8>::ZERO; // use comp_u
-//}
+    // r[0, n) = a >> cnt, cnt < impl_t_bit_sz
+    inline void rshift(impl_t* r, const impl_t* a, size_t n, unsigned cnt){
+        if(cnt == 0){ std::copy(a, a + n, r); return; }
+        for(size_t i=0; i+1<n; i++) r[i] = shrd(a[i], a[i+1], cnt);
+        r[n-1] = (impl_t)(a[n-1] >> cnt);
+    }
 
+    inline impl_t submul_1(impl_t* r, const impl_t* a, size_t n, impl_t b){
+        impl_t borrow = 0;
+        for(size_t i=0; i<n; i++){
+            impl_t hi, lo = mul_wide(a[i], b, hi);
+            lo = (impl_t)(lo + borrow);
+            hi = (impl_t)(hi + (lo < borrow));
+            impl_t s = r[i];
+            r[i] = (impl_t)(s - lo);
+            borrow = (impl_t)(hi + (s < lo));
+        }
+        return borrow;
+    }
+
+    // q[0, n) = a / d, returns a % d
+    inline impl_t divrem_1(impl_t* q, const impl_t* a, size_t n, impl_t d){
+        unsigned cnt = __builtin_clzll((unsigned long long)d) - (64 - impl_t_bit_sz);
+        d = (impl_t)(d << cnt);
+        impl_t v = invert_limb(d);
+
+        impl_t r = cnt ? (impl_t)(a[n-1] >> (impl_t_bit_sz - cnt)) : 0;
+        for(size_t i=n; i>0; i--){
+            impl_t u0 = (impl_t)(a[i-1] << cnt);
+            if(cnt && i > 1) u0 |= (impl_t)(a[i-2] >> (impl_t_bit_sz - cnt));
+            q[i-1] = div_2by1(r, r, u0, d, v);
+        }
+        return (impl_t)(r >> cnt);
+    }
+
+    // schoolbook on a normalized divisor, dn >= 2: q[0, nn-dn) = n / d with the
+    // remainder left in n[0, dn); returns the quotient limb above q, 0 or 1
+    inline impl_t div_qr_sb(impl_t* q, impl_t* n, size_t nn, const impl_t* d, size_t dn){
+        impl_t qh = (cmp(n + nn - dn, dn, d, dn) >= 0);
+        if(qh) sub_n(n + nn - dn, n + nn - dn, d, dn);
+
+        const impl_t d1 = d[dn-1], d0 = d[dn-2];
+        const impl_t v = invert_limb(d1);
+
+        for(size_t j = nn - dn; j > 0; j--){
+            impl_t* u = n + j - 1;
+            impl_t u2 = u[dn], u1 = u[dn-1], u0 = u[dn-2];
+            impl_t qhat, rhat;
+            bool refine = true;
+
+            if(u2 == d1){
+                // the estimate does not fit a limb, cap it at B - 1
+                qhat = (impl_t)~(impl_t)0;
+                rhat = (impl_t)(u1 + d1);
+                refine = (rhat >= u1);
+            } else {
+                qhat = div_2by1(rhat, u2, u1, d1, v);
+            }
+
+            // qhat is at most two too large, the next limb leaves at most one
+            if(refine){
+                impl_t hi, lo = mul_wide(qhat, d0, hi);
+                while(hi > rhat || (hi == rhat && lo > u0)){
+                    qhat--;
+                    impl_t prev = rhat;
+                    rhat = (impl_t)(rhat + d1);
+                    if(rhat < prev) break;
+                    hi = (impl_t)(hi - (lo < d0));
+                    lo = (impl_t)(lo - d0);
+                }
+            }
+
+            impl_t borrow = submul_1(u, d, dn, qhat);
+            impl_t top = u[dn];
+            u[dn] = (impl_t)(top - borrow);
+            if(top < borrow){
+                qhat--;
+                u[dn] = (impl_t)(u[dn] + add_n(u, u, d, dn));
+            }
+            q[j-1] = qhat;
+        }
+        return qh;
+    }
+
+    // divide and conquer (Burnikel, Ziegler) 2n by n limbs on a normalized divisor,
+    // q[0, n) = n / d with the remainder left in n[0, n), returns the high quotient limb;
+    // the quotient halves are fixed up by products from the multiplication tiers,
+    // t holds n limbs
+    inline impl_t div_qr_dc_n(impl_t* q, impl_t* np, const impl_t* d, size_t n, impl_t* t){
+        if(n < BIGINT_DIV_DC_THRESHOLD) return div_qr_sb(q, np, 2*n, d, n);
+
+        size_t lo = n / 2, hi = n - lo;
+
+        // top hi quotient limbs from the top 2*hi limbs and the top half of d
+        impl_t qh = div_qr_dc_n(q + lo, np + 2*lo, d + lo, hi, t);
+        mul_any(t, q + lo, hi, d, lo);
+        impl_t cy = sub_n(np + lo, np + lo, t, n);
+        if(qh) cy += sub_n(np + n, np + n, d, lo);
+        while(cy){
+            qh -= sub_1(q + lo, q + lo, hi, 1);
+            cy -= add_n(np + lo, np + lo, d, n);
+        }
+
+        // low lo quotient limbs from what is left
+        impl_t ql = div_qr_dc_n(q, np + hi, d + hi, lo, t);
+        mul_any(t, d, hi, q, lo);
+        cy = sub_n(np, np, t, n);
+        if(ql) cy += sub_n(np + lo, np + lo, d, hi);
+        while(cy){
+            sub_1(q, q, lo, 1);
+            cy -= add_n(np, np, d, n);
+        }
+        return qh;
+    }
+
+    inline size_t divrem_itch(size_t an, size_t dn){ return an + 1 + 2*dn; }
+
+    // q[0, an-dn+1) = a / d, r[0, dn) = a % d, an >= dn >= 2, d[dn-1] != 0
+    inline void divrem(impl_t* q, impl_t* r, const impl_t* a, size_t an,
+                       const impl_t* d, size_t dn, impl_t* scratch){
+        unsigned cnt = __builtin_clzll((unsigned long long)d[dn-1]) - (64 - impl_t_bit_sz);
+        size_t qn = an + 1 - dn;
+        impl_t* un = scratch;
+        impl_t* vn = un + an + 1;
+        impl_t* t  = vn + dn;
+        // the top limb of un is below the top limb of vn, no quotient limb above q
+        un[an] = lshift(un, a, an, cnt);
+        lshift(vn, d, dn, cnt);
+
+        if(dn < BIGINT_DIV_DC_THRESHOLD || qn < BIGINT_DIV_DC_THRESHOLD){
+            div_qr_sb(q, un, an + 1, vn, dn);
+            rshift(r, un, dn, cnt);
+            return;
+        }
+
+        // the top qn % dn quotient limbs first, then whole 2dn by dn blocks
+        size_t blocks = qn / dn, part = qn % dn;
+        if(part){
+            impl_t* w  = un + blocks * dn;
+            impl_t* qp = q + blocks * dn;
+            if(part < BIGINT_DIV_DC_THRESHOLD){
+                div_qr_sb(qp, w, dn + part, vn, dn);
+            } else {
+                // estimate from the top part limbs of the divisor, then fix up
+                // with the product of the estimate and the rest of the divisor
+                impl_t qh = div_qr_dc_n(qp, w + dn - part, vn + dn - part, part, t);
+                if(dn - part >= part) mul_any(t, vn, dn - part, qp, part);
+                else                  mul_any(t, qp, part, vn, dn - part);
+                impl_t cy = sub_n(w, w, t, dn);
+                if(qh) cy += sub_n(w + part, w + part, vn, dn - part);
+                while(cy){
+                    sub_1(qp, qp, part, 1);
+                    cy -= add_n(w, w, vn, dn);
+                }
+            }
+        }
+        for(size_t j = blocks; j > 0; j--)
+            div_qr_dc_n(q + (j-1) * dn, un + (j-1) * dn, vn, dn, t);
+
+        rshift(r, un, dn, cnt);
+    }
+}
+
+template<size_t SZ1, size_t SZ2> 
+std::pair<Signed<SZ1>, Signed<SZ2>> div_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    constexpr size_t n1 = Signed<SZ1>::segments_count;
+    constexpr size_t n2 = Signed<SZ2>::segments_count;
+    std::pair<Signed<SZ1>, Signed<SZ2>> ret;
+
+    // significant limbs, clz() counts whole zero limbs too
+    size_t an = n1 - lhs.clz() / impl_t_bit_sz;
+    size_t dn = n2 - rhs.clz() / impl_t_bit_sz;
+    assert(dn != 0 && "division by zero");
+
+    if(an < dn){
+        ret.second.assign_segments(lhs._segments.data(), an);
+    } else if(dn == 1){
+        ret.second._segments[0] = detail::divrem_1(ret.first._segments.data(), lhs._segments.data(), an,
+                                                   rhs._segments[0]);
+    } else {
+        if constexpr (n2 < BIGINT_DIV_DC_THRESHOLD){
+            detail::limb_array<n1 + 1 + 2*n2> scratch;
+            detail::divrem(ret.first._segments.data(), ret.second._segments.data(),
+                           lhs._segments.data(), an, rhs._segments.data(), dn, scratch.data());
+        } else {
+            std::vector<impl_t> scratch(detail::divrem_itch(an, dn));
+            detail::divrem(ret.first._segments.data(), ret.second._segments.data(),
+                           lhs._segments.data(), an, rhs._segments.data(), dn, scratch.data());
+        }
+    }
+    return ret;
+}
+
+// the quotient takes the sign of the product, the remainder the sign of the dividend
+template<size_t SZ1, size_t SZ2> 
+std::pair<Signed<SZ1>, Signed<SZ2>> divmod(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    auto ret = div_u(lhs, rhs);
+    ret.first.set_sign(lhs.sign() != rhs.sign() && !ret.first.is_zero());
+    ret.second.set_sign(lhs.is_negative() && !ret.second.is_zero());
+    return ret;
+}
+
+//operator/
+template<size_t SZ, typename T>
+inline Signed<SZ> operator/(const Signed<SZ>& lhs, T rhs){
+    return operator/(lhs, Signed<sizeof(T)*8>(rhs));
+}
+
+template<size_t SZ1, size_t SZ2>
+inline Signed<SZ1> operator/(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    return divmod(lhs, rhs).first;
+}
+
+//operator%
+template<size_t SZ, typename T>
+inline Signed<sizeof(T)*8> operator%(const Signed<SZ>& lhs, T rhs){
+    return operator%(lhs, Signed<sizeof(T)*8>(rhs));
+}
+
+template<size_t SZ1, size_t SZ2>
+inline Signed<SZ2> operator%(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    return divmod(lhs, rhs).second;
+}
 
 // Uniary Operators
 //operator~
@@ -631,8 +2540,7 @@ inline Signed<_SZ> operator~(Signed<_SZ> lhs){
 //operator prefix++;
 template<size_t _SZ>
 inline Signed<_SZ>& operator++(Signed<_SZ>& lhs){
-    lhs = (lhs+1);
-    return lhs;
+    return lhs += 1;
 }
 
 //operator postfix++;
@@ -645,14 +2553,13 @@ inline Signed<_SZ> operator++(Signed<_SZ>& lhs, int){
 
 //operator prefix--
 template<size_t _SZ>
-inline Signed<_SZ>& operator--(Signed<_SZ> lhs){
-    lhs = (lhs-1);
-    return lhs;
+inline Signed<_SZ>& operator--(Signed<_SZ>& lhs){
+    return lhs -= 1;
 }
 
 //operator postfix--
 template<size_t _SZ>
-inline Signed<_SZ> operator--(Signed<_SZ> lhs, int){
+inline Signed<_SZ> operator--(Signed<_SZ>& lhs, int){
     Signed<_SZ> ret(lhs);
     --lhs;
     return ret;
@@ -679,47 +2586,36 @@ inline Signed<_SZ> operator--(Signed<_SZ> lhs, int){
 //operator<<
 template<size_t SZ>
 inline Signed<SZ> operator<<(const Signed<SZ>& lhs, size_t shift){
-    Signed<SZ> ret = lhs;
-    for(size_t i=0; i<lhs.segments_count; i++){
-        size_t msseg_d = shift / (sizeof(impl_t)*8);       // most / least significant segment distnace
-        size_t lsseg_d = shift / (sizeof(impl_t)*8) + 1;   // given in indices
-        size_t msseg_i = i - msseg_d;
-        size_t lsseg_i = i - lsseg_d;
-        impl_t msseg = lhs.get_segment(msseg_i) << (shift - msseg_d*impl_t_bit_sz);
-        impl_t lsseg = lhs.get_segment(lsseg_i) >> (impl_t_bit_sz - (shift - msseg_d*impl_t_bit_sz));
-        ret._segments[i] = msseg | lsseg;
-    }
+    Signed<SZ> ret;
+    ret.flags = lhs.flags;
+    detail::lshift_words(ret._segments.data(), lhs._segments.data(), lhs.segments_count, shift);
     return ret;
 }
 
 
-//operator>>=
+//operator<<=
 template<size_t SZ>
 inline Signed<SZ>& operator<<=(Signed<SZ>& lhs, size_t shift){
-    lhs = lhs << shift;
+    bool lost = shift && detail::lshift_words(lhs._segments.data(), lhs._segments.data(), lhs.segments_count, shift);
+    lhs.flags &= ~Signed<SZ>::TRUNCATED;
+    if(lost) lhs.flags |= Signed<SZ>::TRUNCATED;
     return lhs;
 }
 
 //operator>>
 template<size_t SZ>
 inline Signed<SZ> operator>>(const Signed<SZ>& lhs, size_t shift){
-    Signed<SZ> ret = lhs;
-    for(size_t i=0; i<lhs.segments_count; i++){
-        size_t msseg_d = shift / (sizeof(impl_t)*8) + 1;   // given in indices
-        size_t lsseg_d = shift / (sizeof(impl_t)*8);       // most /least significant segment distnace
-        size_t msseg_i = i + msseg_d;
-        size_t lsseg_i = i + lsseg_d;
-        impl_t msseg = lhs.get_segment(msseg_i) << (impl_t_bit_sz - (shift - lsseg_d*impl_t_bit_sz));
-        impl_t lsseg = lhs.get_segment(lsseg_i) >> (shift - lsseg_d*impl_t_bit_sz);
-        ret._segments[i] = msseg | lsseg;
-    }
+    Signed<SZ> ret;
+    ret.flags = lhs.flags;
+    detail::rshift_words(ret._segments.data(), lhs._segments.data(), lhs.segments_count, shift);
     return ret;
 }
 
 //operator>>=
 template<size_t SZ>
 inline Signed<SZ>& operator>>=(Signed<SZ>& lhs, size_t shift){
-    lhs = lhs >> shift;
+    if(shift) detail::rshift_words(lhs._segments.data(), lhs._segments.data(), lhs.segments_count, shift);
+    lhs.flags &= ~Signed<SZ>::TRUNCATED;
     return lhs;
 }
 
@@ -728,55 +2624,92 @@ inline Signed<SZ>& operator>>=(Signed<SZ>& lhs, size_t shift){
 //operator&
 template<size_t SZ, typename T>
 //std::enable_if_t<std::is_integral_v<T>>
-inline Signed<std::min(SZ, sizeof(T)*8)> operator&(const Signed<SZ>& lhs, const T rhs){
+inline Signed<min_sz(SZ, sizeof(T)*8)> operator&(const Signed<SZ>& lhs, const T rhs){
     return (lhs & Signed<(sizeof(T)*8)>(rhs));
 }
 template<size_t SZ1, size_t SZ2>
-inline Signed<std::min(SZ1, SZ2)> operator&(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    Signed<std::min(SZ1, SZ2)> ret;
-    for(size_t i=0; i < std::min(lhs.segments_count, rhs.segments_count); i++)
+inline Signed<min_sz(SZ1, SZ2)> operator&(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    Signed<min_sz(SZ1, SZ2)> ret;
+    for(size_t i=0; i < min_sz(lhs.segments_count, rhs.segments_count); i++)
         ret._segments[i] = lhs.get_segment(i) & rhs.get_segment(i);
     return ret;
 }
 
+//operator&=, the bitwise operators work on magnitudes and leave a positive value
+template<size_t SZ, typename T>
+inline std::enable_if_t<std::is_integral<T>::value, Signed<SZ>&> operator&=(Signed<SZ>& lhs, const T rhs){
+    return lhs &= Signed<sizeof(T)*8>(rhs);
+}
+template<size_t SZ1, size_t SZ2>
+inline Signed<SZ1>& operator&=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    for(size_t i=0; i < lhs.segments_count; i++) lhs._segments[i] &= rhs.get_segment(i);
+    lhs.flags = 0;
+    return lhs;
+}
+
 //operator|
 template<size_t SZ, typename T>
 //std::enable_if_t<std::is_integral_v<T>>
-inline Signed<std::max(SZ, sizeof(T)*8)> operator|(const Signed<SZ>& lhs, const T rhs){
-    return (lhs & Signed<(sizeof(T)*8)>(rhs));
+inline Signed<max_sz(SZ, sizeof(T)*8)> operator|(const Signed<SZ>& lhs, const T rhs){
+    return (lhs | Signed<(sizeof(T)*8)>(rhs));
 }
 template<size_t SZ1, size_t SZ2>
-inline Signed<std::max(SZ1, SZ2)> operator|(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    Signed<std::max(SZ1, SZ2)> ret;
-    for(size_t i=0; i < std::min(lhs.segments_count, rhs.segments_count); i++)
+inline Signed<max_sz(SZ1, SZ2)> operator|(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    Signed<max_sz(SZ1, SZ2)> ret;
+    for(size_t i=0; i < ret.segments_count; i++)
         ret._segments[i] = lhs.get_segment(i) | rhs.get_segment(i);
     return ret;
 }
 
-//operator^
+//operator|=
 template<size_t SZ, typename T>
-//std::enable_if_t<std::is_integral_v<T>>
-inline Signed<std::max(SZ, sizeof(T)*8)> operator^(const Signed<SZ>& lhs, const T rhs){
-    return (lhs & Signed<(sizeof(T)*8)>(rhs));
+inline std::enable_if_t<std::is_integral<T>::value, Signed<SZ>&> operator|=(Signed<SZ>& lhs, const T rhs){
+    return lhs |= Signed<sizeof(T)*8>(rhs);
 }
 template<size_t SZ1, size_t SZ2>
-inline Signed<std::max(SZ1, SZ2)> operator^(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
-    Signed<std::max(SZ1, SZ2)> ret;
-    for(size_t i=0; i < std::min(lhs.segments_count, rhs.segments_count); i++)
+inline Signed<SZ1>& operator|=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    constexpr size_t m = min_sz(Signed<SZ1>::segments_count, Signed<SZ2>::segments_count);
+    for(size_t i=0; i < m; i++) lhs._segments[i] |= rhs._segments[i];
+    lhs.flags = 0;
+    for(size_t i=m; i < rhs.segments_count; i++)
+        if(rhs._segments[i]){ lhs.flags |= Signed<SZ1>::TRUNCATED; break; }
+    return lhs;
+}
+
+//operator^
+template<size_t SZ, typename T>
+//std::enable_if_t<std::is_integral_v<T>>
+inline Signed<max_sz(SZ, sizeof(T)*8)> operator^(const Signed<SZ>& lhs, const T rhs){
+    return (lhs ^ Signed<(sizeof(T)*8)>(rhs));
+}
+template<size_t SZ1, size_t SZ2>
+inline Signed<max_sz(SZ1, SZ2)> operator^(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    Signed<max_sz(SZ1, SZ2)> ret;
+    for(size_t i=0; i < ret.segments_count; i++)
         ret._segments[i] = lhs.get_segment(i) ^ rhs.get_segment(i);
     return ret;
 }
 
+//operator^=
+template<size_t SZ, typename T>
+inline std::enable_if_t<std::is_integral<T>::value, Signed<SZ>&> operator^=(Signed<SZ>& lhs, const T rhs){
+    return lhs ^= Signed<sizeof(T)*8>(rhs);
+}
+template<size_t SZ1, size_t SZ2>
+inline Signed<SZ1>& operator^=(Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
+    constexpr size_t m = min_sz(Signed<SZ1>::segments_count, Signed<SZ2>::segments_count);
+    for(size_t i=0; i < m; i++) lhs._segments[i] ^= rhs._segments[i];
+    lhs.flags = 0;
+    for(size_t i=m; i < rhs.segments_count; i++)
+        if(rhs._segments[i]){ lhs.flags |= Signed<SZ1>::TRUNCATED; break; }
+    return lhs;
+}
+
 // Relational Operators
 template<size_t SZ1, size_t SZ2>
 inline bool comp_u(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){ //is lhs greater
-    for(size_t i = std::max(lhs.segments_count, rhs.segments_count); i > 0; i--){
-        auto lhs_seg = lhs.get_segment(i-1);
-        auto rhs_seg = rhs.get_segment(i-1);
-        if((bool)lhs_seg xor (bool)rhs_seg) return (lhs_seg == 0);
-        else                                if (lhs_seg > rhs_seg) return true;
-    }
-    return false;
+    detail::limb_view a = lhs.limbs(), b = rhs.limbs();
+    return detail::cmp(a.data, a.size, b.data, b.size) > 0;
 }
 
 //operator>
@@ -807,8 +2740,8 @@ inline bool operator==(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
     if( lhs.sign() != rhs.sign()) 
         return lhs.is_zero() && rhs.is_zero();
 
-    for(size_t i = 0; i < std::max(lhs.segments_count, rhs.segments_count); i++)
-        if(lhs.get_segment(i-1) != rhs.get_segment(i-1)) return false;
+    for(size_t i = 0; i < max_sz(lhs.segments_count, rhs.segments_count); i++)
+        if(lhs.get_segment(i) != rhs.get_segment(i)) return false;
     return true;
 }
 
@@ -829,5 +2762,1714 @@ template<size_t SZ1, size_t SZ2>
 inline bool operator>=(const Signed<SZ1>& lhs, const Signed<SZ2>& rhs){
     return (lhs > rhs || lhs == rhs);
 }
-} //namespace bigint
 
+// =================================================================================
+// Dynamic
+//
+template<typename T, typename>
+Dynamic::Dynamic(T val){
+    unsigned long long uval = val;
+    if constexpr(std::is_signed<T>::value){
+        if(val < 0) uval = 0ull - uval;
+    }
+    for(size_t i=0; i < sizeof(uval) / sizeof(impl_t); i++)
+        _segments.push_back((impl_t)(uval >> i * impl_t_bit_sz));
+    if constexpr(std::is_signed<T>::value){
+        if(val < 0) flags |= NEGATIVE;
+    }
+    normalize();
+}
+
+template<size_t SZ>
+Dynamic::Dynamic(const Signed<SZ>& other)
+    : _segments(other._segments.begin(), other._segments.end()) {
+    flags = other.get_flags() & NEGATIVE;
+    normalize();
+}
+
+inline Dynamic::Dynamic(const View& view)
+    : _segments(view.limbs().data, view.limbs().data + view.segments_count()) {
+    flags = view.is_negative() ? NEGATIVE : 0;
+    normalize();
+}
+
+template<size_t SZ>
+Signed<SZ> Dynamic::to_signed() const {
+    Signed<SZ> ret;
+    ret.assign_segments(_segments.data(), _segments.size());
+    ret.set_sign(is_negative());
+    return ret;
+}
+
+inline Dynamic Dynamic::add_u(const Dynamic& lhs, const Dynamic& rhs){
+    bool swap = lhs._segments.size() < rhs._segments.size();
+    const std::vector<impl_t>& a = swap ? rhs._segments : lhs._segments;
+    const std::vector<impl_t>& b = swap ? lhs._segments : rhs._segments;
+
+    Dynamic ret;
+    ret._segments.resize(a.size());
+    impl_t carry = detail::add(ret._segments.data(), a.data(), a.size(), b.data(), b.size());
+    if(carry) ret._segments.push_back(carry);
+    ret.flags = lhs.flags;
+    ret.normalize();
+    return ret;
+}
+
+inline Dynamic Dynamic::sub_u(const Dynamic& lhs, const Dynamic& rhs){
+    // both are normalized, the larger magnitude has at least as many limbs
+    bool swap = detail::cmp(lhs._segments.data(), lhs._segments.size(),
+                            rhs._segments.data(), rhs._segments.size()) < 0;
+    const std::vector<impl_t>& a = swap ? rhs._segments : lhs._segments;
+    const std::vector<impl_t>& b = swap ? lhs._segments : rhs._segments;
+
+    Dynamic ret;
+    ret._segments.resize(a.size());
+    detail::sub(ret._segments.data(), a.data(), a.size(), b.data(), b.size());
+    ret.normalize();
+    ret.set_sign(swap);
+    return ret;
+}
+
+//operator+
+inline Dynamic operator+(const Dynamic& lhs, const Dynamic& rhs){
+    if(lhs.sign() == rhs.sign())    { return Dynamic::add_u(lhs, rhs);}
+    else                            {
+        if(rhs.is_negative())         return Dynamic::sub_u(lhs, rhs);
+        else                          return Dynamic::sub_u(rhs, lhs);
+    }
+}
+
+//operator-
+inline Dynamic operator-(const Dynamic& lhs, const Dynamic& rhs){
+    if(lhs.sign() == rhs.sign())    {
+        if(lhs.is_negative())         return Dynamic::sub_u(rhs, lhs);
+        else                          return Dynamic::sub_u(lhs, rhs);
+    }
+    else                            { return Dynamic::add_u(lhs, rhs);}
+}
+
+//operator uniary-
+inline Dynamic operator-(const Dynamic& lhs){
+    Dynamic ret = lhs;
+    ret.toggle_sign();
+    return ret;
+}
+
+//operator*
+inline Dynamic operator*(const Dynamic& lhs, const Dynamic& rhs){
+    Dynamic ret;
+    if(lhs.is_zero() || rhs.is_zero()) return ret;
+
+    size_t an = lhs._segments.size(), bn = rhs._segments.size();
+    ret._segments.resize(an + bn);
+    if(&lhs == &rhs)
+        detail::sqr_any(ret._segments.data(), lhs._segments.data(), an);
+    else if(an >= bn)
+        detail::mul_any(ret._segments.data(), lhs._segments.data(), an, rhs._segments.data(), bn);
+    else
+        detail::mul_any(ret._segments.data(), rhs._segments.data(), bn, lhs._segments.data(), an);
+
+    ret.normalize();
+    ret.set_sign(lhs.is_negative() != rhs.is_negative());
+    return ret;
+}
+
+inline Dynamic& operator+=(Dynamic& lhs, const Dynamic& rhs){
+    lhs = lhs + rhs;
+    return lhs;
+}
+
+inline Dynamic& operator-=(Dynamic& lhs, const Dynamic& rhs){
+    lhs = lhs - rhs;
+    return lhs;
+}
+
+inline Dynamic& operator*=(Dynamic& lhs, const Dynamic& rhs){
+    lhs = lhs * rhs;
+    return lhs;
+}
+
+//operator==
+inline bool operator==(const Dynamic& lhs, const Dynamic& rhs){
+    return lhs.flags == rhs.flags && lhs._segments == rhs._segments;
+}
+
+//operator<
+inline bool operator<(const Dynamic& lhs, const Dynamic& rhs){
+    if(lhs.sign() != rhs.sign()) return lhs.is_negative();
+    int c = detail::cmp(lhs._segments.data(), lhs._segments.size(),
+                        rhs._segments.data(), rhs._segments.size());
+    return lhs.is_positive() ? (c < 0) : (c > 0);
+}
+
+inline bool operator!=(const Dynamic& lhs, const Dynamic& rhs){ return !(lhs == rhs); }
+inline bool operator> (const Dynamic& lhs, const Dynamic& rhs){ return rhs < lhs; }
+inline bool operator<=(const Dynamic& lhs, const Dynamic& rhs){ return !(rhs < lhs); }
+inline bool operator>=(const Dynamic& lhs, const Dynamic& rhs){ return !(lhs < rhs); }
+
+// =================================================================================
+// View
+//
+inline View::View(const impl_t* data, size_t count, bool negative) : _data(data), _size(count) {
+    assert(reinterpret_cast<uintptr_t>(data) % alignof(impl_t) == 0 && "view over misaligned limbs");
+    while(_size && _data[_size - 1] == 0) _size--;
+    _negative = negative && _size;
+}
+
+// =================================================================================
+// Montgomery
+//
+// Modular kernels
+// n limb operands below an odd n limb modulus m, minv = -m^-1 mod B
+namespace detail{
+    // m^-1 mod B for an odd m, each Newton step doubles the correct low bits
+    inline impl_t binvert_limb(impl_t m){
+        impl_t inv = m;   // m * m == 1 mod 8
+        for(size_t bits = 3; bits < impl_t_bit_sz; bits *= 2)
+            inv = (impl_t)(inv * (impl_t)(2 - (impl_t)(m * inv)));
+        return inv;
+    }
+
+    // r[0, n) = a * b / B^n mod m, reduction interleaved with the product (CIOS);
+    // t holds n + 2 limbs
+    inline void mont_mul(impl_t* r, const impl_t* a, const impl_t* b, const impl_t* m, size_t n,
+                         impl_t minv, impl_t* t){
+        std::fill(t, t + n + 2, 0);
+        for(size_t i=0; i<n; i++){
+            impl_t c = addmul_1(t, a, n, b[i]);
+            dimpl_t s = (dimpl_t)t[n] + c;
+            t[n]   = (impl_t)s;
+            t[n+1] = (impl_t)(s >> impl_t_bit_sz);
+
+            // t = (t + u * m) / B, the low limb cancels
+            impl_t u = (impl_t)(t[0] * minv);
+            dimpl_t p = (dimpl_t)u * m[0] + t[0];
+            impl_t carry = (impl_t)(p >> impl_t_bit_sz);
+            for(size_t j=1; j<n; j++){
+                p = (dimpl_t)u * m[j] + t[j] + carry;
+                t[j-1] = (impl_t)p;
+                carry = (impl_t)(p >> impl_t_bit_sz);
+            }
+            s = (dimpl_t)t[n] + carry;
+            t[n-1] = (impl_t)s;
+            t[n]   = (impl_t)(t[n+1] + (impl_t)(s >> impl_t_bit_sz));
+        }
+        // t < 2m
+        if(t[n] || cmp(t, n, m, n) >= 0) sub_n(r, t, m, n);
+        else                             std::copy(t, t + n, r);
+    }
+
+    // r[0, n) = t / B^n mod m for t < m * B^n, t[0, 2n) is overwritten (REDC)
+    inline void mont_redc(impl_t* r, impl_t* t, const impl_t* m, size_t n, impl_t minv){
+        impl_t hi = 0;
+        for(size_t i=0; i<n; i++){
+            impl_t u = (impl_t)(t[i] * minv);
+            impl_t c = addmul_1(t + i, m, n, u);
+            dimpl_t s = (dimpl_t)t[i+n] + c + hi;
+            t[i+n] = (impl_t)s;
+            hi = (impl_t)(s >> impl_t_bit_sz);
+        }
+        if(hi || cmp(t + n, n, m, n) >= 0) sub_n(r, t + n, m, n);
+        else                               std::copy(t + n, t + 2*n, r);
+    }
+
+    inline void mod_add(impl_t* r, const impl_t* a, const impl_t* b, const impl_t* m, size_t n){
+        impl_t carry = add_n(r, a, b, n);
+        if(carry || cmp(r, n, m, n) >= 0) sub_n(r, r, m, n);
+    }
+
+    inline void mod_sub(impl_t* r, const impl_t* a, const impl_t* b, const impl_t* m, size_t n){
+        if(sub_n(r, a, b, n)) add_n(r, r, m, n);
+    }
+}
+
+template<size_t _SZ>
+Montgomery<_SZ>::Montgomery(const Signed<_SZ>& modulus) : _m(modulus) {
+    assert(modulus.is_positive() && modulus.bit_at(0) && "modulus must be odd and positive");
+    _minv = (impl_t)(0 - detail::binvert_limb(_m._segments[0]));
+
+    constexpr size_t r2_sz = 2 * Signed<_SZ>::real_bit_sz + 1;
+    Signed<r2_sz> r2;
+    r2._segments[2 * segments_count] = 1;
+    _r2  = r2 % _m;
+    _one = mul(_r2, Signed<_SZ>(1));
+}
+
+template<size_t _SZ>
+template<size_t SZ>
+Signed<_SZ> Montgomery<_SZ>::to_mont(const Signed<SZ>& x) const {
+    Signed<_SZ> ret = x % _m;
+    if(ret.is_negative()){
+        ret.set_sign(false);
+        detail::sub_n(ret._segments.data(), _m._segments.data(), ret._segments.data(), segments_count);
+    }
+    return mul(ret, _r2);
+}
+
+template<size_t _SZ>
+Signed<_SZ> Montgomery<_SZ>::from_mont(const Signed<_SZ>& x) const {
+    Signed<_SZ> ret;
+    detail::limb_array<2 * segments_count> t = {};
+    std::copy(x._segments.begin(), x._segments.end(), t.begin());
+    detail::mont_redc(ret._segments.data(), t.data(), _m._segments.data(), segments_count, _minv);
+    return ret;
+}
+
+template<size_t _SZ>
+Signed<_SZ> Montgomery<_SZ>::mul(const Signed<_SZ>& a, const Signed<_SZ>& b) const {
+    Signed<_SZ> ret;
+    detail::limb_array<segments_count + 2> t;
+    detail::mont_mul(ret._segments.data(), a._segments.data(), b._segments.data(),
+                     _m._segments.data(), segments_count, _minv, t.data());
+    return ret;
+}
+
+// the square skips the repeated cross products, then reduces separately
+template<size_t _SZ>
+Signed<_SZ> Montgomery<_SZ>::sqr(const Signed<_SZ>& a) const {
+    Signed<_SZ> ret;
+    detail::limb_array<2 * segments_count> t;
+    // below a few Karatsuba thresholds the scratch allocation costs more than it saves
+    if constexpr (segments_count < 4 * BIGINT_KARATSUBA_THRESHOLD)
+        detail::sqr_basecase(t.data(), a._segments.data(), segments_count);
+    else
+        detail::sqr_any(t.data(), a._segments.data(), segments_count);
+    detail::mont_redc(ret._segments.data(), t.data(), _m._segments.data(), segments_count, _minv);
+    return ret;
+}
+
+template<size_t _SZ>
+Signed<_SZ> Montgomery<_SZ>::add(const Signed<_SZ>& a, const Signed<_SZ>& b) const {
+    Signed<_SZ> ret;
+    detail::mod_add(ret._segments.data(), a._segments.data(), b._segments.data(),
+                    _m._segments.data(), segments_count);
+    return ret;
+}
+
+template<size_t _SZ>
+Signed<_SZ> Montgomery<_SZ>::sub(const Signed<_SZ>& a, const Signed<_SZ>& b) const {
+    Signed<_SZ> ret;
+    detail::mod_sub(ret._segments.data(), a._segments.data(), b._segments.data(),
+                    _m._segments.data(), segments_count);
+    return ret;
+}
+
+// =================================================================================
+// Barrett
+//
+namespace detail{
+    // r[0, n) = a * b mod B^n, only the product columns below n are formed
+    inline void mullo_basecase(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn, size_t n){
+        std::fill(r, r + n, 0);
+        for(size_t j=0; j < bn && j < n; j++){
+            size_t len = min_sz(an, n - j);
+            impl_t c = addmul_1(r + j, a, len, b[j]);
+            if(j + an < n) r[j + an] = c;
+        }
+    }
+
+    // r[0, an+bn) = a * b less every partial product a_i * b_j with i + j < lo,
+    // short of the exact product by less than B^(lo+3) while min(an, bn) < B
+    inline void mulhi_basecase(impl_t* r, const impl_t* a, size_t an, const impl_t* b, size_t bn, size_t lo){
+        std::fill(r, r + an + bn, 0);
+        for(size_t j=0; j<bn; j++){
+            size_t i = (lo > j) ? lo - j : 0;
+            if(i >= an) continue;
+            r[j + an] = addmul_1(r + j + i, a + i, an - i, b[j]);
+        }
+    }
+
+    // truncated basecase products stay cheaper than full Karatsuba ones up to about twice
+    // its threshold; mulhi_basecase also needs the shorter operand below B
+    constexpr size_t barrett_basecase_limit = min_sz(2 * BIGINT_KARATSUBA_THRESHOLD,
+                                                     (size_t)1 << (impl_t_bit_sz - 1));
+
+    constexpr size_t barrett_itch(size_t n){ return 6*n + 6; }
+
+    // r[0, k) = x mod m for x[0, xn) < B^2n, m with k significant limbs and
+    // mu[0, mun) = floor(B^2n / m); the quotient estimate is at most 3 short
+    inline void barrett_reduce(impl_t* r, const impl_t* x, size_t xn, const impl_t* m, size_t k,
+                               const impl_t* mu, size_t mun, size_t n, impl_t* scratch){
+        impl_t* r1 = scratch;
+        impl_t* r2 = r1 + k + 1;
+        impl_t* q2 = r2 + k + 1;
+
+        // q3 = ((x / B^(k-1)) * mu) / B^(2n-k+1)
+        const impl_t* q3 = nullptr;
+        size_t q3n = 0;
+        if(xn >= k){
+            const impl_t* q1 = x + (k-1);
+            size_t q1n = xn - (k-1);
+            size_t shift = 2*n - k + 1;
+            // the dropped columns cost the estimate at most one more unit
+            if(min_sz(q1n, mun) < barrett_basecase_limit)
+                mulhi_basecase(q2, q1, q1n, mu, mun, (shift > 3) ? shift - 3 : 0);
+            else if(q1n >= mun) mul_any(q2, q1, q1n, mu, mun);
+            else                mul_any(q2, mu, mun, q1, q1n);
+            if(q1n + mun > shift){
+                q3 = q2 + shift;
+                q3n = min_sz(q1n + mun - shift, k + 1);
+            }
+        }
+
+        // r = x - q3 * m mod B^(k+1), then at most three subtractions
+        std::fill(r1, r1 + k + 1, 0);
+        std::copy(x, x + min_sz(xn, k + 1), r1);
+        if(q3n){
+            if(k < barrett_basecase_limit){
+                mullo_basecase(r2, m, k, q3, q3n, k + 1);
+            } else {
+                // the full product is cheaper than the truncated one past the basecase
+                std::vector<impl_t> t(k + q3n);
+                if(k >= q3n) mul_any(t.data(), m, k, q3, q3n);
+                else         mul_any(t.data(), q3, q3n, m, k);
+                std::copy(t.data(), t.data() + k + 1, r2);
+            }
+            sub_n(r1, r1, r2, k + 1);
+        }
+        while(cmp(r1, k + 1, m, k) >= 0) sub(r1, r1, k + 1, m, k);
+        std::copy(r1, r1 + k, r);
+    }
+}
+
+template<size_t _SZ>
+Barrett<_SZ>::Barrett(const Signed<_SZ>& modulus) : _m(modulus) {
+    assert(modulus.is_positive() && !modulus.is_zero() && "modulus must be positive");
+    _k = segments_count - _m.clz() / impl_t_bit_sz;
+
+    Signed<2 * Signed<_SZ>::real_bit_sz + 1> b2n;
+    b2n._segments[2 * segments_count] = 1;
+    auto mu = b2n / _m;
+    _mun = decltype(mu)::segments_count - mu.clz() / impl_t_bit_sz;
+    std::copy(mu._segments.begin(), mu._segments.begin() + _mun, _mu.begin());
+
+    _one = reduce(Signed<_SZ>(1));
+}
+
+template<size_t _SZ>
+template<size_t SZ>
+Signed<_SZ> Barrett<_SZ>::reduce(const Signed<SZ>& x) const {
+    constexpr size_t xn = Signed<SZ>::segments_count;
+    static_assert(xn <= 2 * segments_count, "Barrett reduces at most twice the modulus width");
+
+    Signed<_SZ> ret;
+    detail::limb_array<detail::barrett_itch(segments_count)> scratch;
+    detail::barrett_reduce(ret._segments.data(), x._segments.data(), xn - x.clz() / impl_t_bit_sz,
+                           _m._segments.data(), _k, _mu.data(), _mun, segments_count, scratch.data());
+    if(x.is_negative() && !ret.is_zero())
+        detail::sub_n(ret._segments.data(), _m._segments.data(), ret._segments.data(), _k);
+    return ret;
+}
+
+// =================================================================================
+// Modular exponentiation
+//
+namespace detail{
+    // bits [lo, lo + len) of x, len < 16, read a limb at a time
+    template<size_t SZ>
+    inline size_t bits_at(const Signed<SZ>& x, size_t lo, size_t len){
+        size_t i = lo / impl_t_bit_sz, off = lo % impl_t_bit_sz;
+        uint64_t w = (uint64_t)x.get_segment(i) >> off;
+        if(off + len > impl_t_bit_sz) w |= (uint64_t)x.get_segment(i+1) << (impl_t_bit_sz - off);
+        if constexpr (impl_t_bit_sz < 16){
+            if(off + len > 2*impl_t_bit_sz) w |= (uint64_t)x.get_segment(i+2) << (2*impl_t_bit_sz - off);
+        }
+        return (size_t)(w & ((1u << len) - 1));
+    }
+
+    // window width by exponent length, the table of 2^(k-1) odd powers pays off
+    // once it saves more multiplications than it costs to build
+    inline size_t pow_window(size_t bits){
+        constexpr size_t limits[] = { 7, 25, 81, 241, 673, 1793 };
+        size_t k = 1;
+        for(size_t limit : limits) if(bits > limit) k++;
+        return k;
+    }
+
+    // left to right sliding window over the exponent bits, x in the reducer's form
+    template<typename Reducer, size_t SZ, size_t SZ2>
+    Signed<SZ> pow_sliding(const Reducer& red, const Signed<SZ>& x, const Signed<SZ2>& exp){
+        size_t bits = Signed<SZ2>::real_bit_sz - exp.clz();
+        if(bits == 0) return red.one();
+
+        size_t k = pow_window(bits);
+        std::vector<Signed<SZ>> table((size_t)1 << (k-1));
+        table[0] = x;
+        if(k > 1){
+            Signed<SZ> x2 = red.sqr(x);
+            for(size_t i=1; i<table.size(); i++) table[i] = red.mul(table[i-1], x2);
+        }
+
+        Signed<SZ> r;
+        bool first = true;
+        size_t i = bits;
+        while(i > 0){
+            if(!bits_at(exp, i-1, 1)){
+                r = red.sqr(r);
+                i--;
+                continue;
+            }
+            // longest window ending in a set bit
+            size_t len = min_sz(k, i);
+            size_t w = bits_at(exp, i - len, len);
+            while(!(w & 1)){ w >>= 1; len--; }
+
+            if(first){
+                r = table[w >> 1];
+                first = false;
+            } else {
+                for(size_t j=0; j<len; j++) r = red.sqr(r);
+                r = red.mul(r, table[w >> 1]);
+            }
+            i -= len;
+        }
+        return r;
+    }
+}
+
+// base^exp mod m for exp >= 0 and m > 0, the result is in [0, m)
+template<size_t SZ1, size_t SZ2, size_t SZ3>
+Signed<SZ3> powmod(const Signed<SZ1>& base, const Signed<SZ2>& exp, const Signed<SZ3>& mod){
+    assert(!exp.is_negative() && "negative exponent");
+    assert(mod.is_positive() && !mod.is_zero() && "modulus must be positive");
+
+    if(mod.bit_at(0)){
+        Montgomery<SZ3> mont(mod);
+        return mont.from_mont(detail::pow_sliding(mont, mont.to_mont(base), exp));
+    }
+
+    Barrett<SZ3> red(mod);
+    Signed<SZ3> x = base % mod;
+    if(x.is_negative()) x = x + mod;
+    return detail::pow_sliding(red, x, exp);
+}
+
+// =================================================================================
+// Constant time
+//
+// Constant time kernels, control flow and memory access depend on the sizes only,
+// never on limb values; selections are masks instead of branches
+namespace detail{
+    // all ones for bit 1, zero for bit 0
+    inline impl_t ct_mask(impl_t bit){ return (impl_t)(0 - bit); }
+
+    // 1 when x == 0, else 0
+    inline size_t ct_is_zero(size_t x){ return (~x & (x - 1)) >> (sizeof(size_t)*8 - 1); }
+
+    // r = a where mask is set, b elsewhere; r may alias either
+    inline void ct_select(impl_t* r, const impl_t* a, const impl_t* b, size_t n, impl_t mask){
+        for(size_t i=0; i<n; i++) r[i] = (impl_t)(b[i] ^ ((a[i] ^ b[i]) & mask));
+    }
+
+    // borrow out of a - b, the difference is not stored
+    inline impl_t ct_borrow(const impl_t* a, const impl_t* b, size_t n){
+        unsigned char borrow = 0;
+        for(size_t i=0; i<n; i++) subb(a[i], b[i], borrow);
+        return borrow;
+    }
+
+    // r = -a when neg is 1, a when 0
+    inline void ct_cnd_neg(impl_t* r, const impl_t* a, size_t n, impl_t neg){
+        impl_t mask = ct_mask(neg);
+        unsigned char carry = (unsigned char)neg;
+        for(size_t i=0; i<n; i++) r[i] = addc((impl_t)(a[i] ^ mask), 0, carry);
+    }
+
+    // r = table[index], every entry is read
+    inline void ct_lookup(impl_t* r, const impl_t* table, size_t entries, size_t n, size_t index){
+        std::fill(r, r + n, 0);
+        for(size_t e=0; e<entries; e++){
+            impl_t mask = ct_mask((impl_t)ct_is_zero(e ^ index));
+            for(size_t i=0; i<n; i++) r[i] |= (impl_t)(table[e*n + i] & mask);
+        }
+    }
+
+    // mont_mul with the final subtraction always computed and kept by mask
+    inline void ct_mont_mul(impl_t* r, const impl_t* a, const impl_t* b, const impl_t* m, size_t n,
+                            impl_t minv, impl_t* t){
+        std::fill(t, t + n + 2, 0);
+        for(size_t i=0; i<n; i++){
+            impl_t c = addmul_1(t, a, n, b[i]);
+            dimpl_t s = (dimpl_t)t[n] + c;
+            t[n]   = (impl_t)s;
+            t[n+1] = (impl_t)(s >> impl_t_bit_sz);
+
+            impl_t u = (impl_t)(t[0] * minv);
+            dimpl_t p = (dimpl_t)u * m[0] + t[0];
+            impl_t carry = (impl_t)(p >> impl_t_bit_sz);
+            for(size_t j=1; j<n; j++){
+                p = (dimpl_t)u * m[j] + t[j] + carry;
+                t[j-1] = (impl_t)p;
+                carry = (impl_t)(p >> impl_t_bit_sz);
+            }
+            s = (dimpl_t)t[n] + carry;
+            t[n-1] = (impl_t)s;
+            t[n]   = (impl_t)(t[n+1] + (impl_t)(s >> impl_t_bit_sz));
+        }
+        // t < 2m, t - m is negative only when it borrows and t[n] is clear
+        unsigned char borrow = 0;
+        for(size_t i=0; i<n; i++) r[i] = subb(t[i], m[i], borrow);
+        ct_select(r, t, r, n, ct_mask((impl_t)(borrow & (t[n] ^ 1))));
+    }
+
+    // fixed window width of the constant time powmod
+    constexpr size_t ct_pow_window = 4;
+}
+
+namespace ct{
+// |lhs| + |rhs|
+template<size_t SZ>
+Signed<SZ+1> add(const Signed<SZ>& lhs, const Signed<SZ>& rhs){
+    constexpr size_t n = Signed<SZ>::segments_count;
+    Signed<SZ+1> ret;
+    impl_t carry = detail::add_n(ret._segments.data(), lhs._segments.data(), rhs._segments.data(), n);
+    if constexpr (Signed<SZ+1>::segments_count > n) ret._segments[n] = carry;
+    return ret;
+}
+
+// |lhs| - |rhs|, the sign is taken from the borrow instead of a comparison
+template<size_t SZ>
+Signed<SZ+1> sub(const Signed<SZ>& lhs, const Signed<SZ>& rhs){
+    constexpr size_t n = Signed<SZ>::segments_count;
+    Signed<SZ+1> ret;
+    impl_t borrow = detail::sub_n(ret._segments.data(), lhs._segments.data(), rhs._segments.data(), n);
+    detail::ct_cnd_neg(ret._segments.data(), ret._segments.data(), n, borrow);
+    ret.flags = (uint8_t)(borrow * Signed<SZ+1>::NEGATIVE);
+    return ret;
+}
+
+// sign of |lhs| - |rhs| as -1, 0 or 1
+template<size_t SZ>
+int cmp(const Signed<SZ>& lhs, const Signed<SZ>& rhs){
+    detail::limb_view a = lhs.limbs(), b = rhs.limbs();
+    return (int)detail::ct_borrow(b.data, a.data, a.size) - (int)detail::ct_borrow(a.data, b.data, a.size);
+}
+
+// |lhs| == |rhs|
+template<size_t SZ>
+bool equal(const Signed<SZ>& lhs, const Signed<SZ>& rhs){
+    detail::limb_view a = lhs.limbs(), b = rhs.limbs();
+    impl_t diff = 0;
+    for(size_t i=0; i<a.size; i++) diff |= (impl_t)(a.data[i] ^ b.data[i]);
+    return detail::ct_is_zero(diff);
+}
+
+// cond ? a : b
+template<size_t SZ>
+Signed<SZ> select(bool cond, const Signed<SZ>& a, const Signed<SZ>& b){
+    Signed<SZ> ret;
+    impl_t mask = detail::ct_mask((impl_t)cond);
+    detail::ct_select(ret._segments.data(), a._segments.data(), b._segments.data(),
+                      Signed<SZ>::segments_count, mask);
+    ret.flags = (uint8_t)(b.flags ^ ((a.flags ^ b.flags) & (uint8_t)mask));
+    return ret;
+}
+
+// Montgomery product of a, b in [0, m)
+template<size_t SZ>
+Signed<SZ> mul(const Montgomery<SZ>& mont, const Signed<SZ>& a, const Signed<SZ>& b){
+    constexpr size_t n = Signed<SZ>::segments_count;
+    Signed<SZ> ret;
+    detail::limb_array<n + 2> t;
+    detail::ct_mont_mul(ret._segments.data(), a._segments.data(), b._segments.data(),
+                        mont._m._segments.data(), n, mont._minv, t.data());
+    return ret;
+}
+
+// base^exp mod m for base in [0, m) and exp >= 0, over every bit of exp's width:
+// a fixed window, no skipped zero windows and a table lookup that reads every entry.
+// Only the modulus and the widths may be public, the sign of exp is ignored
+template<size_t SZ, size_t SZ2>
+Signed<SZ> powmod(const Signed<SZ>& base, const Signed<SZ2>& exp, const Montgomery<SZ>& mont){
+    constexpr size_t n = Signed<SZ>::segments_count;
+    constexpr size_t k = detail::ct_pow_window;
+    constexpr size_t entries = (size_t)1 << k;
+    constexpr size_t windows = (Signed<SZ2>::real_bit_sz + k - 1) / k;
+    const impl_t* m = mont._m._segments.data();
+
+    detail::limb_array<n + 2> t;
+    std::vector<impl_t> table(entries * n);
+    std::copy(mont._one._segments.begin(), mont._one._segments.end(), table.begin());
+    detail::ct_mont_mul(&table[n], base._segments.data(), mont._r2._segments.data(), m, n, mont._minv, t.data());
+    for(size_t e=2; e<entries; e++)
+        detail::ct_mont_mul(&table[e*n], &table[(e-1)*n], &table[n], m, n, mont._minv, t.data());
+
+    Signed<SZ> ret, w;
+    impl_t* r = ret._segments.data();
+    detail::ct_lookup(r, table.data(), entries, n, detail::bits_at(exp, (windows - 1) * k, k));
+    for(size_t i = windows - 1; i > 0; i--){
+        for(size_t j=0; j<k; j++) detail::ct_mont_mul(r, r, r, m, n, mont._minv, t.data());
+        detail::ct_lookup(w._segments.data(), table.data(), entries, n, detail::bits_at(exp, (i-1) * k, k));
+        detail::ct_mont_mul(r, r, w._segments.data(), m, n, mont._minv, t.data());
+    }
+
+    // out of Montgomery form, a product with 1
+    std::fill(w._segments.begin(), w._segments.end(), 0);
+    w._segments[0] = 1;
+    detail::ct_mont_mul(r, r, w._segments.data(), m, n, mont._minv, t.data());
+    return ret;
+}
+} // namespace ct
+
+// =================================================================================
+// Decimal conversion
+//
+// Quadratic below BIGINT_DEC_DC_THRESHOLD limbs, a chunk of dec_digits digits per
+// limb operation; above it the value is split by 10^(dec_digits * 2^i) and both
+// halves converted recursively, which inherits the speed of division and mul_any
+namespace detail{
+    // most decimal digits whose power of ten stays below B
+    constexpr size_t dec_digits = (impl_t_bit_sz == 8) ? 2 : (impl_t_bit_sz == 16) ? 4 :
+                                  (impl_t_bit_sz == 32) ? 9 : 19;
+    constexpr impl_t dec_base = []{ impl_t p = 1; for(size_t i=0; i<dec_digits; i++) p *= 10; return p; }();
+
+    // 10^(dec_digits * 2^i), squared from the previous one once per i and shared
+    inline limb_view dec_power(size_t i){
+        static std::vector<impl_t> tables[64];
+        static std::once_flag built[64];
+        std::call_once(built[i], [&]{
+            std::vector<impl_t> p;
+            if(i == 0){
+                p.push_back(dec_base);
+            } else {
+                limb_view h = dec_power(i-1);
+                p.resize(2 * h.size);
+                sqr_any(p.data(), h.data, h.size);
+                while(p.back() == 0) p.pop_back();
+            }
+            tables[i] = std::move(p);
+        });
+        return { tables[i].data(), tables[i].size() };
+    }
+
+    // out[0, digits) = a[0, n) zero padded, a < 10^digits; a is overwritten
+    inline void dec_to_chars(char* out, size_t digits, impl_t* a, size_t n){
+        while(n && a[n-1] == 0) n--;
+        if(n < BIGINT_DEC_DC_THRESHOLD){
+            char* p = out + digits;
+            while(n){
+                impl_t c = divrem_1(a, a, n, dec_base);
+                if(a[n-1] == 0) n--;
+                for(size_t j=0; j<dec_digits && p > out; j++, c /= 10) *--p = (char)('0' + c % 10);
+            }
+            std::fill(out, p, '0');
+            return;
+        }
+
+        // the largest cached power with about half the limbs of a
+        size_t i = 0;
+        while(2 * dec_power(i+1).size <= n) i++;
+        limb_view d = dec_power(i);
+        size_t lo_digits = dec_digits << i;
+
+        std::vector<impl_t> q(n - d.size + 1), r(d.size), scratch(divrem_itch(n, d.size));
+        if(d.size == 1) r[0] = divrem_1(q.data(), a, n, d.data[0]);
+        else            divrem(q.data(), r.data(), a, n, d.data, d.size, scratch.data());
+        dec_to_chars(out + digits - lo_digits, lo_digits, r.data(), r.size());
+        dec_to_chars(out, digits - lo_digits, q.data(), q.size());
+    }
+
+    // r = the value of digits s[0, len), returns its significant limbs;
+    // r holds at least dec_limbs(len)
+    inline size_t dec_limbs(size_t len){ return len / dec_digits + 2; }
+
+    inline size_t dec_from_chars(impl_t* r, const char* s, size_t len){
+        // a limb product per chunk is cheaper than the division per chunk of dec_to_chars,
+        // the quadratic loop pays for itself twice as long
+        if(len / dec_digits < 2 * BIGINT_DEC_DC_THRESHOLD){
+            size_t rn = 0;
+            size_t head = len % dec_digits;
+            for(size_t off = 0; off < len; ){
+                size_t take = (off == 0 && head) ? head : dec_digits;
+                impl_t c = 0, mul = 1;
+                for(size_t j=0; j<take; j++, mul *= 10) c = (impl_t)(c * 10 + (impl_t)(s[off + j] - '0'));
+                for(size_t j=0; j<rn; j++){
+                    dimpl_t p = (dimpl_t)r[j] * mul + c;
+                    r[j] = (impl_t)p;
+                    c = (impl_t)(p >> impl_t_bit_sz);
+                }
+                if(c) r[rn++] = c;
+                off += take;
+            }
+            return rn;
+        }
+
+        // value = hi * 10^lo_digits + lo with the largest cached power below len digits
+        size_t i = 0;
+        while((dec_digits << (i+1)) < len) i++;
+        limb_view d = dec_power(i);
+        size_t lo_digits = dec_digits << i;
+
+        std::vector<impl_t> hi(dec_limbs(len - lo_digits)), lo(dec_limbs(lo_digits));
+        size_t hn = dec_from_chars(hi.data(), s, len - lo_digits);
+        size_t ln = dec_from_chars(lo.data(), s + len - lo_digits, lo_digits);
+
+        size_t rn = 0;
+        if(hn){
+            if(hn >= d.size) mul_any(r, hi.data(), hn, d.data, d.size);
+            else             mul_any(r, d.data, d.size, hi.data(), hn);
+            rn = hn + d.size;
+        }
+        if(ln > rn){
+            std::fill(r + rn, r + ln, 0);
+            rn = ln;
+        }
+        if(ln) add(r, r, rn, lo.data(), ln);
+        while(rn && r[rn-1] == 0) rn--;
+        return rn;
+    }
+}
+
+template<size_t _SZ>
+std::string Signed<_SZ>::to_decimal() const {
+    size_t bits = real_bit_sz - clz();
+    if(bits == 0) return "0";
+
+    // 2^bits < 10^digits
+    size_t digits = (size_t)(bits * 0.30102999566398120) + 1;
+    size_t n = (bits + impl_t_bit_sz - 1) / impl_t_bit_sz;
+    std::vector<impl_t> a(_segments.begin(), _segments.begin() + n);
+    std::string str(digits + 1, '0');
+    detail::dec_to_chars(&str[1], digits, a.data(), n);
+
+    size_t lead = str.find_first_not_of('0', 1);
+    if(is_negative()){
+        str[lead - 1] = '-';
+        return str.substr(lead - 1);
+    }
+    return str.substr(lead);
+}
+
+template<size_t _SZ>
+bool Signed<_SZ>::from_decimal(std::string_view str){
+    std::fill(_segments.begin(), _segments.end(), 0);
+    flags = 0;
+    bool negative = !str.empty() && str[0] == '-';
+    if(!str.empty() && (str[0] == '-' || str[0] == '+')) str.remove_prefix(1);
+    if(str.empty()) return false;
+    for(char c : str) if(c < '0' || c > '9') return false;
+
+    std::vector<impl_t> r(detail::dec_limbs(str.size()));
+    size_t rn = detail::dec_from_chars(r.data(), str.data(), str.size());
+    assign_segments(r.data(), rn);
+    set_sign(negative && !is_zero());
+    return true;
+}
+
+// =================================================================================
+// Hex and binary conversion
+//
+// A 64 bit word of the magnitude at a time, 16 hex or 64 binary characters;
+// the word tricks assume a little-endian target like the rest of the limb code
+namespace detail{
+    // 64 bit word i of a[0, n), zero past the end
+    inline uint64_t word64_at(const impl_t* a, size_t n, size_t i){
+        if constexpr (impl_t_bit_sz == 64){
+            return (i < n) ? (uint64_t)a[i] : 0;
+        } else {
+            constexpr size_t per = 64 / impl_t_bit_sz;
+            uint64_t w = 0;
+            for(size_t j=0; j<per && i*per + j < n; j++) w |= (uint64_t)a[i*per + j] << (j * impl_t_bit_sz);
+            return w;
+        }
+    }
+
+    // stores word i into a[0, n), returns false when nonzero bits fall outside
+    inline bool word64_put(impl_t* a, size_t n, size_t i, uint64_t w){
+        if constexpr (impl_t_bit_sz == 64){
+            if(i < n) a[i] = (impl_t)w;
+            return i < n || w == 0;
+        } else {
+            constexpr size_t per = 64 / impl_t_bit_sz;
+            bool fits = true;
+            for(size_t j=0; j<per; j++){
+                impl_t limb = (impl_t)(w >> (j * impl_t_bit_sz));
+                if(i*per + j < n) a[i*per + j] = limb;
+                else              fits &= (limb == 0);
+            }
+            return fits;
+        }
+    }
+
+    // out[0, 16) = w in hex, most significant digit first
+    inline void hex_word(char* out, uint64_t w){
+#if defined(__SSSE3__)
+        // one shuffle looks up all 16 nibbles
+        const __m128i digits = _mm_setr_epi8('0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f');
+        const __m128i low4 = _mm_set1_epi8(0x0F);
+        __m128i v  = _mm_cvtsi64_si128((long long)__builtin_bswap64(w));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low4);
+        __m128i lo = _mm_and_si128(v, low4);
+        _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(hi, lo)));
+#else
+        // spread 8 nibbles into 8 bytes, then '0' + n, plus 39 more for the letters
+        for(int half = 0; half < 2; half++){
+            uint64_t v = (w >> (half ? 0 : 32)) & 0xFFFFFFFF;
+            v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+            v = (v | (v << 8))  & 0x00FF00FF00FF00FFull;
+            v = (v | (v << 4))  & 0x0F0F0F0F0F0F0F0Full;
+            v = __builtin_bswap64(v);
+            uint64_t letters = ((v + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull;
+            v += 0x3030303030303030ull + letters * 39;
+            std::memcpy(out + 8*half, &v, 8);
+        }
+#endif
+    }
+
+    // out[0, 64) = w in binary, most significant bit first
+    inline void bin_word(char* out, uint64_t w){
+        for(int byte = 7; byte >= 0; byte--){
+            // bit 7 - i of the byte into byte i of the word
+            uint64_t v = ((uint64_t)((w >> (8*byte)) & 0xFF) * 0x0101010101010101ull) & 0x0102040810204080ull;
+            v = ((v + 0x7F7F7F7F7F7F7F7Full) >> 7) & 0x0101010101010101ull;
+            v += 0x3030303030303030ull;
+            std::memcpy(out + 8*(7 - byte), &v, 8);
+        }
+    }
+
+    // value of a hex digit, 0x80 for anything else
+    inline uint8_t hex_value(char c){
+        static const auto table = []{
+            std::array<uint8_t, 256> t{};
+            t.fill(0x80);
+            for(int i=0; i<10; i++) t['0' + i] = (uint8_t)i;
+            for(int i=0; i<6; i++) t['a' + i] = t['A' + i] = (uint8_t)(10 + i);
+            return t;
+        }();
+        return table[(unsigned char)c];
+    }
+
+    // word of the hex digits s[0, len), len <= 16; false on a non digit
+    inline bool hex_parse(const char* s, size_t len, uint64_t& w){
+        uint8_t bad = 0;
+        w = 0;
+        size_t i = 0;
+        for(; i < len % 8; i++){
+            uint8_t d = hex_value(s[i]);
+            bad |= d;
+            w = (w << 4) | (d & 0x0F);
+        }
+        constexpr uint64_t ones = 0x0101010101010101ull, high = 0x8080808080808080ull;
+        // 0x80 in every byte of x < 0x80 that lies in [lo, hi], no carries cross bytes
+        auto in_range = [](uint64_t x, uint64_t lo, uint64_t hi){
+            return (x + (0x80 - lo) * ones) & ~(x + (0x7F - hi) * ones) & high;
+        };
+        for(; i < len; i += 8){
+            uint64_t v;
+            std::memcpy(&v, s + i, 8);
+            uint64_t ok = in_range(v, '0', '9') | in_range(v | 0x2020202020202020ull, 'a', 'f');
+            if((v & high) || ok != high) bad = 0x80;
+            // the low nibble of '0'-'9', 'a'-'f' and 'A'-'F', plus 9 for the letters
+            v = (v & 0x0F0F0F0F0F0F0F0Full) + ((v >> 6) & 0x0101010101010101ull) * 9;
+            // 8 digit bytes into 8 nibbles, the first digit highest
+            v = __builtin_bswap64(v);
+            v = (v | (v >> 4))  & 0x00FF00FF00FF00FFull;
+            v = (v | (v >> 8))  & 0x0000FFFF0000FFFFull;
+            v = (v | (v >> 16)) & 0x00000000FFFFFFFFull;
+            w = (w << 32) | v;
+        }
+        return !(bad & 0x80);
+    }
+
+    // word of the binary digits s[0, len), len <= 64; false on a non digit
+    inline bool bin_parse(const char* s, size_t len, uint64_t& w){
+        w = 0;
+        size_t i = 0;
+        for(; i < len % 8; i++){
+            if((s[i] | 1) != '1') return false;
+            w = (w << 1) | (uint64_t)(s[i] & 1);
+        }
+        for(; i < len; i += 8){
+            uint64_t v;
+            std::memcpy(&v, s + i, 8);
+            v ^= 0x3030303030303030ull;
+            if(v & 0xFEFEFEFEFEFEFEFEull) return false;
+            // byte i lands on bit 7 - i of the top byte, no carries below it
+            w = (w << 8) | ((v * 0x8040201008040201ull) >> 56);
+        }
+        return true;
+    }
+
+    // shared by to_hex and to_binary, digits per word and a word formatter
+    template<size_t bits_per_digit>
+    inline size_t radix2_to_chars(char* buf, size_t size, const impl_t* a, size_t n, size_t bits, bool negative){
+        constexpr size_t per_word = 64 / bits_per_digit;
+        size_t digits = bits ? (bits + bits_per_digit - 1) / bits_per_digit : 1;
+        size_t len = digits + negative;
+        if(size < len) return len;
+
+        char* p = buf;
+        if(negative) *p++ = '-';
+        size_t words = (digits + per_word - 1) / per_word;
+        char top[per_word];
+        auto format = [](char* out, uint64_t w){
+            if constexpr (bits_per_digit == 4) hex_word(out, w);
+            else                               bin_word(out, w);
+        };
+        format(top, word64_at(a, n, words - 1));
+        size_t lead = digits - (words - 1) * per_word;
+        std::memcpy(p, top + per_word - lead, lead);
+        p += lead;
+        for(size_t i = words - 1; i > 0; i--, p += per_word) format(p, word64_at(a, n, i - 1));
+        return len;
+    }
+}
+
+template<size_t _SZ>
+size_t Signed<_SZ>::to_hex(char* buf, size_t size) const {
+    return detail::radix2_to_chars<4>(buf, size, _segments.data(), segments_count,
+                                      real_bit_sz - clz(), is_negative() && !is_zero());
+}
+
+template<size_t _SZ>
+size_t Signed<_SZ>::to_binary(char* buf, size_t size) const {
+    return detail::radix2_to_chars<1>(buf, size, _segments.data(), segments_count,
+                                      real_bit_sz - clz(), is_negative() && !is_zero());
+}
+
+template<size_t _SZ>
+std::string Signed<_SZ>::to_hex() const {
+    std::string str(to_hex(nullptr, 0), '\0');
+    to_hex(&str[0], str.size());
+    return str;
+}
+
+template<size_t _SZ>
+std::string Signed<_SZ>::to_binary() const {
+    std::string str(to_binary(nullptr, 0), '\0');
+    to_binary(&str[0], str.size());
+    return str;
+}
+
+template<size_t _SZ>
+std::string Signed<_SZ>::binary_string() const {
+    constexpr size_t words = (real_bit_sz + 63) / 64;
+    std::string str(words * 64, '0');
+    for(size_t i=0; i<words; i++)
+        detail::bin_word(&str[(words - 1 - i) * 64], detail::word64_at(_segments.data(), segments_count, i));
+    return str.substr(words * 64 - _SZ);
+}
+
+template<size_t _SZ>
+bool Signed<_SZ>::from_hex(std::string_view str){
+    std::fill(_segments.begin(), _segments.end(), 0);
+    flags = 0;
+    bool negative = !str.empty() && str[0] == '-';
+    if(!str.empty() && (str[0] == '-' || str[0] == '+')) str.remove_prefix(1);
+    if(str.empty()) return false;
+
+    // 16 digit words from the right, the leftmost one may be short
+    bool fits = true;
+    for(size_t i=0, end = str.size(); end > 0; i++){
+        size_t len = min_sz(end, 16);
+        uint64_t w;
+        if(!detail::hex_parse(str.data() + end - len, len, w)){
+            std::fill(_segments.begin(), _segments.end(), 0);
+            flags = 0;
+            return false;
+        }
+        fits &= detail::word64_put(_segments.data(), segments_count, i, w);
+        end -= len;
+    }
+    if(!fits) flags |= TRUNCATED;
+    set_sign(negative && !is_zero());
+    return true;
+}
+
+template<size_t _SZ>
+bool Signed<_SZ>::from_binary(std::string_view str){
+    std::fill(_segments.begin(), _segments.end(), 0);
+    flags = 0;
+    bool negative = !str.empty() && str[0] == '-';
+    if(!str.empty() && (str[0] == '-' || str[0] == '+')) str.remove_prefix(1);
+    if(str.empty()) return false;
+
+    bool fits = true;
+    for(size_t i=0, end = str.size(); end > 0; i++){
+        size_t len = min_sz(end, 64);
+        uint64_t w;
+        if(!detail::bin_parse(str.data() + end - len, len, w)){
+            std::fill(_segments.begin(), _segments.end(), 0);
+            flags = 0;
+            return false;
+        }
+        fits &= detail::word64_put(_segments.data(), segments_count, i, w);
+        end -= len;
+    }
+    if(!fits) flags |= TRUNCATED;
+    set_sign(negative && !is_zero());
+    return true;
+}
+
+// =================================================================================
+// Batched arithmetic
+//
+// Many same-size values in lockstep, stored structure of arrays: limb j of every value
+// is contiguous, so one vector instruction works on limb j of several values at once.
+// Values are two's complement in the limbs of a Signed<_SZ+1>, carries and borrows
+// stay in the lanes as compare masks (0 or all ones). The kernels are written once
+// over GCC vector types and picked at run time: AVX-512 (F and BW), AVX2, or 16 byte
+// vectors that the compiler lowers to plain scalar code where there is no vector unit.
+namespace detail{
+    typedef impl_t batch_v16 __attribute__((vector_size(16)));
+    typedef impl_t batch_v32 __attribute__((vector_size(32)));
+    typedef impl_t batch_v64 __attribute__((vector_size(64)));
+    typedef typename std::make_signed<impl_t>::type batch_simpl_t;
+    typedef batch_simpl_t batch_sv16 __attribute__((vector_size(16)));
+    typedef batch_simpl_t batch_sv32 __attribute__((vector_size(32)));
+    typedef batch_simpl_t batch_sv64 __attribute__((vector_size(64)));
+
+    // values are padded to a multiple of this, whole vectors on every path
+    constexpr size_t batch_lanes = 64 / sizeof(impl_t);
+
+    // vectors only ever go through references and pointers: passed by value, 32 and
+    // 64 byte vectors have a different ABI with and without AVX
+    template<typename V>
+    __attribute__((always_inline)) inline void batch_load(V& v, const impl_t* p){
+        std::memcpy(&v, p, sizeof(V));
+    }
+
+    template<typename V>
+    __attribute__((always_inline)) inline void batch_store(impl_t* p, const V& v){
+        std::memcpy(p, &v, sizeof(V));
+    }
+
+    // limb i of a value when i < len, else the sign fill of the limb x held before;
+    // the fill of a fill is itself, so x runs on past the top limb
+    template<typename V, typename SV>
+    __attribute__((always_inline)) inline void batch_limb(V& x, const impl_t* p, size_t i, size_t len){
+        if(i < len) batch_load(x, p);
+        else        x = (V)((SV)x >> (int)(impl_t_bit_sz - 1));
+    }
+
+    // full lane products from half width pieces, no vector unit has a wide multiply
+    template<typename V>
+    __attribute__((always_inline)) inline void batch_mul_wide(V& lo, V& hi, const V& x, const V& y){
+        constexpr int h = impl_t_bit_sz / 2;
+        const V low = V{} + (impl_t)(((impl_t)1 << h) - 1);
+        V x0 = x & low, x1 = x >> h, y0 = y & low, y1 = y >> h;
+        V p00 = x0 * y0, p01 = x0 * y1, p10 = x1 * y0, p11 = x1 * y1;
+        V mid = (p00 >> h) + (p01 & low) + (p10 & low);
+        hi = p11 + (p01 >> h) + (p10 >> h) + (mid >> h);
+        lo = (p00 & low) | (mid << h);
+    }
+
+    // r = a + b or a - b over rl limbs, shorter operands sign extended; the carry
+    // mask is subtracted, so all ones adds one
+    struct batch_add_kernel{
+        template<typename V, typename SV>
+        __attribute__((always_inline)) static void run(impl_t* r, size_t rl, const impl_t* a, size_t al,
+                                                       const impl_t* b, size_t bl, size_t stride, bool subtract){
+            const V flip = subtract ? ~V{} : V{};
+            for(size_t k=0; k<stride; k += sizeof(V) / sizeof(impl_t)){
+                V x = {}, y = {}, carry = flip;
+                for(size_t i=0; i<rl; i++){
+                    batch_limb<V, SV>(x, a + i*stride + k, i, al);
+                    batch_limb<V, SV>(y, b + i*stride + k, i, bl);
+                    V s = x + (y ^ flip);
+                    V c = (V)(s < x);
+                    V s2 = s - carry;
+                    carry = c | (V)(s2 < s);
+                    batch_store(r + i*stride + k, s2);
+                }
+            }
+        }
+    };
+
+    // out[k] = sign of a[k] - b[k], from the top limb down; the top limb compares signed
+    struct batch_cmp_kernel{
+        template<typename V, typename SV>
+        __attribute__((always_inline)) static void run(int8_t* out, size_t count, const impl_t* a, size_t al,
+                                                       const impl_t* b, size_t bl, size_t stride){
+            constexpr size_t lanes = sizeof(V) / sizeof(impl_t);
+            size_t n = max_sz(al, bl);
+            for(size_t k=0; k<stride; k += lanes){
+                V xs, ys;
+                batch_load(xs, a + (al-1)*stride + k);
+                batch_load(ys, b + (bl-1)*stride + k);
+                // past the top limb, so both become their sign fill
+                batch_limb<V, SV>(xs, nullptr, al, al);
+                batch_limb<V, SV>(ys, nullptr, bl, bl);
+                V res = {};   // 0 undecided, 1 greater, all ones less
+                for(size_t i = n; i-- > 0;){
+                    V x = xs, y = ys;
+                    if(i < al) batch_load(x, a + i*stride + k);
+                    if(i < bl) batch_load(y, b + i*stride + k);
+                    V gt = (i == n-1) ? (V)((SV)x > (SV)y) : (V)(x > y);
+                    V lt = (i == n-1) ? (V)((SV)x < (SV)y) : (V)(x < y);
+                    res |= (V)(res == 0) & ((gt & 1) | lt);
+                }
+                for(size_t j=0; j<lanes && k+j < count; j++) out[k+j] = (int8_t)(batch_simpl_t)res[j];
+            }
+        }
+    };
+
+    // r = a * v over rl limbs, a sign extended
+    struct batch_mul_1_kernel{
+        template<typename V, typename SV>
+        __attribute__((always_inline)) static void run(impl_t* r, size_t rl, const impl_t* a, size_t al,
+                                                       impl_t v, size_t stride){
+            const V vv = V{} + v;
+            for(size_t k=0; k<stride; k += sizeof(V) / sizeof(impl_t)){
+                V x = {}, carry = {};
+                for(size_t i=0; i<rl; i++){
+                    batch_limb<V, SV>(x, a + i*stride + k, i, al);
+                    V lo, hi;
+                    batch_mul_wide(lo, hi, x, vv);
+                    lo += carry;
+                    carry = hi - (V)(lo < carry);
+                    batch_store(r + i*stride + k, lo);
+                }
+            }
+        }
+    };
+
+    // mont_mul in every lane: r[0, n) = a * b / B^n mod m for a, b in [0, m), limbs n to
+    // rl of r cleared; t holds n + 2 limbs of vectors
+    struct batch_mont_mul_kernel{
+        template<typename V, typename SV>
+        __attribute__((always_inline)) static void run(impl_t* r, size_t rl, const impl_t* a, const impl_t* b,
+                                                       const impl_t* m, size_t n, impl_t minv, size_t stride, impl_t* tbuf){
+            constexpr size_t lanes = sizeof(V) / sizeof(impl_t);
+            auto t_at = [&](size_t j){ return tbuf + j*lanes; };
+            const V vminv = V{} + minv;
+
+            // t[j] += lo, then the incoming carry; the outgoing one is hi plus both overflows
+            auto add_at = [&](size_t dst, size_t j, const V& lo, const V& hi, V& carry){
+                V tj;
+                batch_load(tj, t_at(j));
+                V s = lo + tj;
+                V c = (V)(s < lo);
+                V s2 = s + carry;
+                carry = hi - c - (V)(s2 < carry);
+                batch_store(t_at(dst), s2);
+            };
+
+            for(size_t k=0; k<stride; k += lanes){
+                for(size_t j=0; j<n+2; j++) batch_store(t_at(j), V{});
+                for(size_t i=0; i<n; i++){
+                    V bi, x, lo, hi, tn, carry = {};
+                    batch_load(bi, b + i*stride + k);
+                    for(size_t j=0; j<n; j++){
+                        batch_load(x, a + j*stride + k);
+                        batch_mul_wide(lo, hi, x, bi);
+                        add_at(j, j, lo, hi, carry);
+                    }
+                    batch_load(tn, t_at(n));
+                    tn += carry;
+                    batch_store(t_at(n), tn);
+                    batch_store(t_at(n+1), (V)(tn < carry) & 1);
+
+                    // t = (t + u * m) / B, the low limb cancels
+                    V t0, u;
+                    batch_load(t0, t_at(0));
+                    u = t0 * vminv;
+                    batch_mul_wide(lo, hi, u, V{} + m[0]);
+                    carry = hi - (V)(lo + t0 < lo);
+                    for(size_t j=1; j<n; j++){
+                        batch_mul_wide(lo, hi, u, V{} + m[j]);
+                        add_at(j-1, j, lo, hi, carry);
+                    }
+                    V tn1;
+                    batch_load(tn, t_at(n));
+                    batch_load(tn1, t_at(n+1));
+                    tn += carry;
+                    batch_store(t_at(n-1), tn);
+                    batch_store(t_at(n), tn1 - (V)(tn < carry));
+                }
+
+                // t < 2m, keep t - m unless it borrows with t[n] clear
+                V tj, d, borrow = {};
+                for(size_t j=0; j<n; j++){
+                    V mj = V{} + m[j];
+                    batch_load(tj, t_at(j));
+                    d = tj - mj;
+                    V b1 = (V)(tj < mj);
+                    V d2 = d + borrow;
+                    borrow = b1 | (V)(d2 > d);
+                    batch_store(r + j*stride + k, d2);
+                }
+                V keep;
+                batch_load(keep, t_at(n));
+                keep = borrow & (V)(keep == 0);
+                for(size_t j=0; j<n; j++){
+                    batch_load(d, r + j*stride + k);
+                    batch_load(tj, t_at(j));
+                    batch_store(r + j*stride + k, (tj & keep) | (d & ~keep));
+                }
+                for(size_t j=n; j<rl; j++) batch_store(r + j*stride + k, V{});
+            }
+        }
+    };
+
+    enum class batch_isa{ generic, avx2, avx512 };
+
+    inline batch_isa batch_isa_detect(){
+#if defined(__x86_64__) && defined(__GNUC__)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return batch_isa::avx512;
+        if(__builtin_cpu_supports("avx2")) return batch_isa::avx2;
+#endif
+        return batch_isa::generic;
+    }
+
+    // the path every batch operation takes, detected once; may be lowered, never raised
+    // past what batch_isa_detect reports
+    inline batch_isa& batch_path(){
+        static batch_isa isa = batch_isa_detect();
+        return isa;
+    }
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    template<typename Kernel, typename... Args>
+    __attribute__((target("avx512f,avx512bw"))) inline void batch_run_avx512(Args... args){
+        Kernel::template run<batch_v64, batch_sv64>(args...);
+    }
+
+    template<typename Kernel, typename... Args>
+    __attribute__((target("avx2"))) inline void batch_run_avx2(Args... args){
+        Kernel::template run<batch_v32, batch_sv32>(args...);
+    }
+#endif
+
+    template<typename Kernel, typename... Args>
+    inline void batch_run(Args... args){
+#if defined(__x86_64__) && defined(__GNUC__)
+        switch(batch_path()){
+        case batch_isa::avx512: batch_run_avx512<Kernel>(args...); return;
+        case batch_isa::avx2:   batch_run_avx2<Kernel>(args...);   return;
+        default: break;
+        }
+#endif
+        Kernel::template run<batch_v16, batch_sv16>(args...);
+    }
+} // namespace detail
+
+// a resizable run of Signed<_SZ> values laid out limb by limb, see above
+template<size_t _SZ>
+class Batch{
+public:
+    // one bit more than Signed<_SZ> holds the two's complement sign
+    constexpr static size_t segments_count = Signed<_SZ+1>::segments_count;
+
+    Batch() = default;
+    explicit Batch(size_t count){ resize(count); }
+
+    size_t size() const { return _count; }
+    // distance between limb j and limb j+1 of a value, size() rounded up to whole vectors
+    size_t stride() const { return _stride; }
+    // new values are zero
+    void resize(size_t count);
+
+    Signed<_SZ> get(size_t index) const;
+    void set(size_t index, const Signed<_SZ>& value);
+
+    // limb j of every value, stride() of them
+    impl_t*       limb(size_t j)       { return _data.data() + j*_stride; }
+    const impl_t* limb(size_t j) const { return _data.data() + j*_stride; }
+
+private:
+    std::vector<impl_t> _data;
+    size_t _count = 0;
+    size_t _stride = 0;
+}; // class Batch
+
+    template<size_t _SZ>
+    using batch = Batch<_SZ>;
+
+template<size_t _SZ>
+void Batch<_SZ>::resize(size_t count){
+    size_t stride = (count + detail::batch_lanes - 1) / detail::batch_lanes * detail::batch_lanes;
+    if(stride != _stride){
+        std::vector<impl_t> data(segments_count * stride);
+        for(size_t j=0; j<segments_count; j++)
+            std::copy(limb(j), limb(j) + min_sz(_count, count), data.data() + j*stride);
+        _data.swap(data);
+        _stride = stride;
+    } else {
+        for(size_t j=0; j<segments_count; j++) std::fill(limb(j) + min_sz(_count, count), limb(j) + _stride, 0);
+    }
+    _count = count;
+}
+
+template<size_t _SZ>
+Signed<_SZ> Batch<_SZ>::get(size_t index) const {
+    assert(index < _count);
+    std::array<impl_t, segments_count> mag;
+    for(size_t j=0; j<segments_count; j++) mag[j] = limb(j)[index];
+    bool negative = mag[segments_count - 1] >> (impl_t_bit_sz - 1);
+    if(negative){
+        for(auto& s : mag) s = (impl_t)~s;
+        detail::add_1(mag.data(), mag.data(), segments_count, 1);
+    }
+    return Signed<_SZ>(View(mag.data(), segments_count, negative));
+}
+
+template<size_t _SZ>
+void Batch<_SZ>::set(size_t index, const Signed<_SZ>& value){
+    assert(index < _count);
+    impl_t carry = value.is_negative();
+    for(size_t j=0; j<segments_count; j++){
+        impl_t s = value.get_segment(j);
+        if(value.is_negative()){ s = (impl_t)(~s + carry); carry &= (s == 0); }
+        limb(j)[index] = s;
+    }
+}
+
+template<size_t SZ1, size_t SZ2>
+Batch<max_sz(SZ1,SZ2)+1> operator+(const Batch<SZ1>& lhs, const Batch<SZ2>& rhs){
+    assert(lhs.size() == rhs.size());
+    Batch<max_sz(SZ1,SZ2)+1> ret(lhs.size());
+    detail::batch_run<detail::batch_add_kernel>(ret.limb(0), ret.segments_count, lhs.limb(0), lhs.segments_count,
+                                                rhs.limb(0), rhs.segments_count, ret.stride(), false);
+    return ret;
+}
+
+template<size_t SZ1, size_t SZ2>
+Batch<max_sz(SZ1,SZ2)+1> operator-(const Batch<SZ1>& lhs, const Batch<SZ2>& rhs){
+    assert(lhs.size() == rhs.size());
+    Batch<max_sz(SZ1,SZ2)+1> ret(lhs.size());
+    detail::batch_run<detail::batch_add_kernel>(ret.limb(0), ret.segments_count, lhs.limb(0), lhs.segments_count,
+                                                rhs.limb(0), rhs.segments_count, ret.stride(), true);
+    return ret;
+}
+
+template<size_t SZ>
+Batch<SZ + impl_t_bit_sz> operator*(const Batch<SZ>& lhs, impl_t rhs){
+    Batch<SZ + impl_t_bit_sz> ret(lhs.size());
+    detail::batch_run<detail::batch_mul_1_kernel>(ret.limb(0), ret.segments_count, lhs.limb(0), lhs.segments_count,
+                                                  rhs, ret.stride());
+    return ret;
+}
+
+// -1, 0 or 1 for each lhs[k] against rhs[k]
+template<size_t SZ1, size_t SZ2>
+std::vector<int8_t> cmp(const Batch<SZ1>& lhs, const Batch<SZ2>& rhs){
+    assert(lhs.size() == rhs.size());
+    std::vector<int8_t> ret(lhs.size());
+    detail::batch_run<detail::batch_cmp_kernel>(ret.data(), ret.size(), lhs.limb(0), lhs.segments_count,
+                                                rhs.limb(0), rhs.segments_count, lhs.stride());
+    return ret;
+}
+
+// Montgomery products a[k] * b[k] / R mod m, for values in [0, m) already in Montgomery form
+template<size_t SZ>
+Batch<SZ> mul(const Montgomery<SZ>& mont, const Batch<SZ>& a, const Batch<SZ>& b){
+    assert(a.size() == b.size());
+    constexpr size_t n = Montgomery<SZ>::segments_count;
+    Batch<SZ> ret(a.size());
+    const impl_t* m = mont.modulus().limbs().data;
+    impl_t minv = (impl_t)(0 - detail::binvert_limb(m[0]));
+    std::vector<impl_t> t((n + 2) * detail::batch_lanes);
+    detail::batch_run<detail::batch_mont_mul_kernel>(ret.limb(0), ret.segments_count, a.limb(0), b.limb(0),
+                                                     m, n, minv, ret.stride(), t.data());
+    return ret;
+}
+
+// =================================================================================
+// Expression templates
+//
+// Opt in with lazy(x): operators on an Expr build nodes instead of wider temporaries,
+// and assigning to a Signed evaluates the whole tree in one pass. Sums and differences
+// flatten into signed terms accumulated in place in two's complement, products of two
+// operands go in row by row with addmul_1 / submul_1, shifts and bitwise operations are
+// read limb by limb from their operands. Values, truncation and the result width match
+// the eager operators; only products whose factors are not plain values evaluate those
+// factors first. An Expr refers to its operands, evaluate it in the statement that builds it.
+namespace detail{
+    template<size_t SZ>
+    struct expr_leaf{
+        constexpr static size_t bits = SZ;
+        const Signed<SZ>& x;
+    };
+
+    template<typename L, typename R, bool Subtract>
+    struct expr_sum{
+        constexpr static size_t bits = max_sz(L::bits, R::bits) + 1;
+        L l;
+        R r;
+    };
+
+    template<typename L, typename R>
+    struct expr_product{
+        constexpr static size_t bits = L::bits + R::bits;
+        L l;
+        R r;
+    };
+
+    template<typename L, bool Left>
+    struct expr_shift{
+        constexpr static size_t bits = L::bits;
+        L l;
+        size_t shift;
+    };
+
+    // Op is '&', '|' or '^'
+    template<typename L, typename R, char Op>
+    struct expr_bitwise{
+        constexpr static size_t bits = (Op == '&') ? min_sz(L::bits, R::bits) : max_sz(L::bits, R::bits);
+        L l;
+        R r;
+    };
+
+    // acc[0, n) += or -= the len limbs limb(0), limb(1), ..., modulo B^n
+    template<typename F>
+    inline void expr_add(impl_t* acc, size_t n, const F& limb, size_t len, bool subtract){
+        unsigned char c = 0;
+        size_t i = 0;
+        if(subtract){
+            for(; i<len; i++)    acc[i] = subb(acc[i], limb(i), c);
+            for(; c && i<n; i++) acc[i] = subb(acc[i], 0, c);
+        } else {
+            for(; i<len; i++)    acc[i] = addc(acc[i], limb(i), c);
+            for(; c && i<n; i++) acc[i] = addc(acc[i], 0, c);
+        }
+    }
+
+    template<typename Node>
+    inline bool expr_evaluate(impl_t* acc, size_t n, const Node& e);
+
+    // a node's value as limbs with the width of its eager result: leaves in place,
+    // anything else evaluated once into storage of its own
+    struct expr_operand{
+        const impl_t* data;
+        size_t size;
+        bool negative;
+    };
+
+    template<typename Node>
+    struct expr_held{
+        constexpr static size_t n = Signed<Node::bits + 1>::segments_count;
+        limb_array<n> acc = {};
+        bool negative;
+
+        explicit expr_held(const Node& e) : negative(expr_evaluate(acc.data(), n, e)) {}
+        expr_operand get() const { return { acc.data(), Signed<Node::bits>::segments_count, negative }; }
+    };
+
+    template<size_t SZ>
+    struct expr_held<expr_leaf<SZ>>{
+        const Signed<SZ>& x;
+
+        explicit expr_held(const expr_leaf<SZ>& e) : x(e.x) {}
+        expr_operand get() const { return { x.limbs().data, Signed<SZ>::segments_count, x.is_negative() }; }
+    };
+
+    template<size_t SZ>
+    inline void expr_accumulate(impl_t* acc, size_t n, const expr_leaf<SZ>& e, bool negate){
+        const impl_t* x = e.x.limbs().data;
+        expr_add(acc, n, [x](size_t i){ return x[i]; }, Signed<SZ>::segments_count, negate != e.x.is_negative());
+    }
+
+    template<typename L, typename R, bool Subtract>
+    inline void expr_accumulate(impl_t* acc, size_t n, const expr_sum<L, R, Subtract>& e, bool negate){
+        expr_accumulate(acc, n, e.l, negate);
+        expr_accumulate(acc, n, e.r, negate != Subtract);
+    }
+
+    template<typename L, typename R>
+    inline void expr_accumulate(impl_t* acc, size_t n, const expr_product<L, R>& e, bool negate){
+        expr_held<L> hl(e.l);
+        expr_held<R> hr(e.r);
+        expr_operand x = hl.get(), y = hr.get();
+        while(x.size && !x.data[x.size - 1]) x.size--;
+        while(y.size && !y.data[y.size - 1]) y.size--;
+        if(x.size < y.size) std::swap(x, y);
+        if(y.size == 0) return;
+        bool subtract = negate != (x.negative != y.negative);
+
+        // the product has at least x.size + y.size - 1 limbs and fits in n,
+        // so only the carry out of the last rows can fall off the top
+        if(y.size < BIGINT_KARATSUBA_THRESHOLD){
+            for(size_t j=0; j<y.size; j++){
+                impl_t c = subtract ? submul_1(acc + j, x.data, x.size, y.data[j])
+                                    : addmul_1(acc + j, x.data, x.size, y.data[j]);
+                if(j + x.size < n) expr_add(acc + j + x.size, n - j - x.size, [c](size_t){ return c; }, 1, subtract);
+            }
+        } else {
+            std::vector<impl_t> prod(x.size + y.size);
+            mul_any(prod.data(), x.data, x.size, y.data, y.size);
+            expr_add(acc, n, [&prod](size_t i){ return prod[i]; }, min_sz(prod.size(), n), subtract);
+        }
+    }
+
+    // operator<< and operator>> move the magnitude within the operand's limbs
+    template<typename L, bool Left>
+    inline void expr_accumulate(impl_t* acc, size_t n, const expr_shift<L, Left>& e, bool negate){
+        expr_held<L> h(e.l);
+        expr_operand x = h.get();
+        size_t q = e.shift / impl_t_bit_sz, r = e.shift % impl_t_bit_sz;
+        auto at = [&x](size_t i){ return (i < x.size) ? x.data[i] : (impl_t)0; };
+        auto limb = [&](size_t i) -> impl_t {
+            if(Left) return (impl_t)(((i >= q) ? (impl_t)(at(i - q) << r) : 0) |
+                                     ((r && i >= q + 1) ? (impl_t)(at(i - q - 1) >> (impl_t_bit_sz - r)) : 0));
+            return (impl_t)((impl_t)(at(i + q) >> r) | (r ? (impl_t)(at(i + q + 1) << (impl_t_bit_sz - r)) : 0));
+        };
+        expr_add(acc, n, limb, x.size, negate != x.negative);
+    }
+
+    // as the eager operators, on magnitudes and never negative
+    template<typename L, typename R, char Op>
+    inline void expr_accumulate(impl_t* acc, size_t n, const expr_bitwise<L, R, Op>& e, bool negate){
+        expr_held<L> hl(e.l);
+        expr_held<R> hr(e.r);
+        expr_operand x = hl.get(), y = hr.get();
+        auto at = [](const expr_operand& o, size_t i){ return (i < o.size) ? o.data[i] : (impl_t)0; };
+        auto limb = [&](size_t i) -> impl_t {
+            if(Op == '&') return x.data[i] & y.data[i];
+            if(Op == '|') return at(x, i) | at(y, i);
+            return at(x, i) ^ at(y, i);
+        };
+        expr_add(acc, n, limb, (Op == '&') ? min_sz(x.size, y.size) : max_sz(x.size, y.size), negate);
+    }
+
+    // acc[0, n) zeroed on entry holds |value| on return, true when the value is negative
+    template<typename Node>
+    inline bool expr_evaluate(impl_t* acc, size_t n, const Node& e){
+        expr_accumulate(acc, n, e, false);
+        bool negative = acc[n-1] >> (impl_t_bit_sz - 1);
+        if(negative){
+            for(size_t i=0; i<n; i++) acc[i] = (impl_t)~acc[i];
+            add_1(acc, acc, n, 1);
+        }
+        return negative;
+    }
+} // namespace detail
+
+template<typename Node>
+class Expr{
+public:
+    // width of the Signed the eager operators would have produced
+    constexpr static size_t bits = Node::bits;
+
+    explicit Expr(const Node& node) : _node(node) {}
+    const Node& node() const { return _node; }
+
+private:
+    Node _node;
+}; // class Expr
+
+template<size_t SZ>
+inline Expr<detail::expr_leaf<SZ>> lazy(const Signed<SZ>& x){
+    return Expr<detail::expr_leaf<SZ>>({ x });
+}
+
+// the value in the eager result width
+template<typename Node>
+inline Signed<Node::bits> eval(const Expr<Node>& expr){
+    return Signed<Node::bits>(expr);
+}
+
+template<size_t _SZ>
+template<typename Node>
+Signed<_SZ>::Signed(const Expr<Node>& expr){
+    *this = expr;
+}
+
+template<size_t _SZ>
+template<typename Node>
+Signed<_SZ>& Signed<_SZ>::operator=(const Expr<Node>& expr){
+    constexpr size_t n = Signed<Node::bits + 1>::segments_count;
+    detail::limb_array<n> acc = {};
+    bool negative = detail::expr_evaluate(acc.data(), n, expr.node());
+    assign_segments(acc.data(), n);
+    set_sign(negative);
+    return *this;
+}
+
+//operator+
+template<typename N1, typename N2>
+inline Expr<detail::expr_sum<N1, N2, false>> operator+(const Expr<N1>& lhs, const Expr<N2>& rhs){
+    return Expr<detail::expr_sum<N1, N2, false>>({ lhs.node(), rhs.node() });
+}
+template<typename N, size_t SZ>
+inline Expr<detail::expr_sum<N, detail::expr_leaf<SZ>, false>> operator+(const Expr<N>& lhs, const Signed<SZ>& rhs){
+    return lhs + lazy(rhs);
+}
+template<size_t SZ, typename N>
+inline Expr<detail::expr_sum<detail::expr_leaf<SZ>, N, false>> operator+(const Signed<SZ>& lhs, const Expr<N>& rhs){
+    return lazy(lhs) + rhs;
+}
+
+//operator-
+template<typename N1, typename N2>
+inline Expr<detail::expr_sum<N1, N2, true>> operator-(const Expr<N1>& lhs, const Expr<N2>& rhs){
+    return Expr<detail::expr_sum<N1, N2, true>>({ lhs.node(), rhs.node() });
+}
+template<typename N, size_t SZ>
+inline Expr<detail::expr_sum<N, detail::expr_leaf<SZ>, true>> operator-(const Expr<N>& lhs, const Signed<SZ>& rhs){
+    return lhs - lazy(rhs);
+}
+template<size_t SZ, typename N>
+inline Expr<detail::expr_sum<detail::expr_leaf<SZ>, N, true>> operator-(const Signed<SZ>& lhs, const Expr<N>& rhs){
+    return lazy(lhs) - rhs;
+}
+
+//operator*
+template<typename N1, typename N2>
+inline Expr<detail::expr_product<N1, N2>> operator*(const Expr<N1>& lhs, const Expr<N2>& rhs){
+    return Expr<detail::expr_product<N1, N2>>({ lhs.node(), rhs.node() });
+}
+template<typename N, size_t SZ>
+inline Expr<detail::expr_product<N, detail::expr_leaf<SZ>>> operator*(const Expr<N>& lhs, const Signed<SZ>& rhs){
+    return lhs * lazy(rhs);
+}
+template<size_t SZ, typename N>
+inline Expr<detail::expr_product<detail::expr_leaf<SZ>, N>> operator*(const Signed<SZ>& lhs, const Expr<N>& rhs){
+    return lazy(lhs) * rhs;
+}
+
+//operator<<
+template<typename N>
+inline Expr<detail::expr_shift<N, true>> operator<<(const Expr<N>& lhs, size_t shift){
+    return Expr<detail::expr_shift<N, true>>({ lhs.node(), shift });
+}
+
+//operator>>
+template<typename N>
+inline Expr<detail::expr_shift<N, false>> operator>>(const Expr<N>& lhs, size_t shift){
+    return Expr<detail::expr_shift<N, false>>({ lhs.node(), shift });
+}
+
+//operator&
+template<typename N1, typename N2>
+inline Expr<detail::expr_bitwise<N1, N2, '&'>> operator&(const Expr<N1>& lhs, const Expr<N2>& rhs){
+    return Expr<detail::expr_bitwise<N1, N2, '&'>>({ lhs.node(), rhs.node() });
+}
+template<typename N, size_t SZ>
+inline Expr<detail::expr_bitwise<N, detail::expr_leaf<SZ>, '&'>> operator&(const Expr<N>& lhs, const Signed<SZ>& rhs){
+    return lhs & lazy(rhs);
+}
+template<size_t SZ, typename N>
+inline Expr<detail::expr_bitwise<detail::expr_leaf<SZ>, N, '&'>> operator&(const Signed<SZ>& lhs, const Expr<N>& rhs){
+    return lazy(lhs) & rhs;
+}
+
+//operator|
+template<typename N1, typename N2>
+inline Expr<detail::expr_bitwise<N1, N2, '|'>> operator|(const Expr<N1>& lhs, const Expr<N2>& rhs){
+    return Expr<detail::expr_bitwise<N1, N2, '|'>>({ lhs.node(), rhs.node() });
+}
+template<typename N, size_t SZ>
+inline Expr<detail::expr_bitwise<N, detail::expr_leaf<SZ>, '|'>> operator|(const Expr<N>& lhs, const Signed<SZ>& rhs){
+    return lhs | lazy(rhs);
+}
+template<size_t SZ, typename N>
+inline Expr<detail::expr_bitwise<detail::expr_leaf<SZ>, N, '|'>> operator|(const Signed<SZ>& lhs, const Expr<N>& rhs){
+    return lazy(lhs) | rhs;
+}
+
+//operator^
+template<typename N1, typename N2>
+inline Expr<detail::expr_bitwise<N1, N2, '^'>> operator^(const Expr<N1>& lhs, const Expr<N2>& rhs){
+    return Expr<detail::expr_bitwise<N1, N2, '^'>>({ lhs.node(), rhs.node() });
+}
+template<typename N, size_t SZ>
+inline Expr<detail::expr_bitwise<N, detail::expr_leaf<SZ>, '^'>> operator^(const Expr<N>& lhs, const Signed<SZ>& rhs){
+    return lhs ^ lazy(rhs);
+}
+template<size_t SZ, typename N>
+inline Expr<detail::expr_bitwise<detail::expr_leaf<SZ>, N, '^'>> operator^(const Signed<SZ>& lhs, const Expr<N>& rhs){
+    return lazy(lhs) ^ rhs;
+}
+} //namespace bigint
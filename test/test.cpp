@@ -7,6 +7,8 @@
 #include <iostream>
 #include <random>
 #include <bitset>
+#include <cstring>
+#include <memory>
 
 #define private public // :)
 #include "bigint.h"
@@ -82,6 +84,32 @@ TEST_CASE( "Constructors" ) {
         REQUIRE(bint.was_truncated() == true);
         REQUIRE(equal(bint, tint));
     }
+
+    SECTION( "heap backed storage above BIGINT_HEAP_THRESHOLD" ) {
+        using small_limbs = decltype(bigint::s<128>::_segments);
+        REQUIRE(std::is_same<small_limbs, std::array<impl_t, bigint::s<128>::segments_count>>::value);
+
+        constexpr size_t big_sz = 1048576;
+        REQUIRE(sizeof(bigint::s<big_sz>) < 64);
+
+        bigint::s<big_sz> bint1(mt64());
+        bint1 = bint1 * bint1 + bint1;
+        bint1.toggle_sign();
+        const impl_t* limbs = bint1._segments.data();
+
+        // moves hand the block over, copies are deep
+        bigint::s<big_sz> bint2 = std::move(bint1);
+        REQUIRE(bint2._segments.data() == limbs);
+        bigint::s<big_sz> bint3 = bint2;
+        REQUIRE(bint3._segments.data() != limbs);
+        REQUIRE(bint3 == bint2);
+
+        bint1 = bint3;
+        REQUIRE(bint1 == bint2);
+        bint3 = std::move(bint1);
+        REQUIRE(bint3 == bint2);
+        REQUIRE(bint3.is_negative());
+    }
 }
 
 TEST_CASE( "Comparison" ) {
@@ -134,6 +162,27 @@ TEST_CASE( "Comparison" ) {
             REQUIRE(bint1 != bint2);
         }
     }
+
+    SECTION( "Ordering is decided by the highest differing limb" ) {
+        TIMES(100) {
+            uint64_t datain1[16] = {};
+            uint64_t datain2[16];
+
+            for(auto& d : datain2) d = mt64();
+            datain1[8] = 1;
+            for(size_t j = 8; j < 16; j++) datain2[j] = 0;
+
+            bigint::s<1024> bint1;
+            bigint::s<1024> bint2;
+            REQUIRE(bint1.import(datain1, 16));
+            REQUIRE(bint2.import(datain2, 16));
+
+            REQUIRE(bint1 > bint2);
+            REQUIRE(bint2 < bint1);
+            REQUIRE(!(bint1 < bint2));
+            REQUIRE(bint1 >= bint2);
+        }
+    }
 }
 
 TEST_CASE( "Addition" ) {
@@ -167,6 +216,65 @@ TEST_CASE( "Addition" ) {
 }
 
 TEST_CASE( "Subtraction" ) {
+
+    SECTION( "signed 64 bit range operator+ and operator-" ) {
+        TIMES(1000) {
+            int64_t tint1 = (int32_t)mt32();
+            int64_t tint2 = (int32_t)mt32();
+
+            bigint::s<64> bint1(tint1);
+            bigint::s<64> bint2(tint2);
+
+            REQUIRE((bint1 - bint2) == bigint::s<64>(tint1 - tint2));
+            REQUIRE((bint2 - bint1) == bigint::s<64>(tint2 - tint1));
+            REQUIRE((bint1 + bint2) == bigint::s<64>(tint1 + tint2));
+            REQUIRE((bint1 - bint1).is_zero());
+        }
+    }
+    SECTION( "4096 bit range random operator+ and operator- with gmp" ) {
+        TIMES(200) {
+            uint64_t datain1[64];
+            uint64_t datain2[64];
+
+            for(auto& d : datain1) d = mt64();
+            for(auto& d : datain2) d = mt64();
+            // full length carry and borrow ripple
+            if(i % 4 == 0) for(auto& d : datain1) d = (uint64_t)-1;
+            if(i % 4 == 1) for(size_t j = 1; j < 64; j++) datain2[j] = datain1[j];
+
+            bigint::s<4096> bint1;
+            bigint::s<4096> bint2;
+            REQUIRE(bint1.import(datain1, 64));
+            REQUIRE(bint2.import(datain2, 64));
+            if(i % 3 == 0) bint1.toggle_sign();
+            if(i % 5 == 0) bint2.toggle_sign();
+
+            mpz_t gmpint1, gmpint2, gmpint_result;
+            mpz_inits(gmpint1, gmpint2, gmpint_result, NULL);
+            mpz_import(gmpint1, 64, -1, sizeof(uint64_t), 0, 0, datain1);
+            mpz_import(gmpint2, 64, -1, sizeof(uint64_t), 0, 0, datain2);
+            if(bint1.is_negative()) mpz_neg(gmpint1, gmpint1);
+            if(bint2.is_negative()) mpz_neg(gmpint2, gmpint2);
+
+            for(int op = 0; op < 2; op++){
+                bigint::s<4097> bint_result = op ? bint1 - bint2 : bint1 + bint2;
+                if(op) mpz_sub(gmpint_result, gmpint1, gmpint2);
+                else   mpz_add(gmpint_result, gmpint1, gmpint2);
+
+                uint64_t gmpint_result_data[65] = {};
+                size_t count = 0;
+                mpz_export(gmpint_result_data, &count, -1, sizeof(uint64_t), 0, 0,
+                           gmpint_result);
+
+                bigint::s<4160> gmpint_result_bint;
+                REQUIRE(gmpint_result_bint.import(gmpint_result_data, 65));
+                if(mpz_sgn(gmpint_result) < 0) gmpint_result_bint.toggle_sign();
+
+                REQUIRE(gmpint_result_bint == bint_result);
+            }
+            mpz_clears(gmpint1, gmpint2, gmpint_result, NULL);
+        }
+    }
 }
 
 TEST_CASE( "Multiplication" ) {
@@ -220,8 +328,275 @@ TEST_CASE( "Multiplication" ) {
             REQUIRE(gmpint_result_bint == bint_result);
         }
     }
+    SECTION( "signed operator*(bigint, bigint)" ) {
+        TIMES(1000) {
+            int64_t tint1 = (int32_t)mt32();
+            int64_t tint2 = (int32_t)mt32();
+            int64_t tint_result = tint1 * tint2;
+
+            bigint::s<64> bint1(tint1);
+            bigint::s<64> bint2(tint2);
+            auto bint_result = bint1 * bint2;
+
+            REQUIRE(bint_result == bigint::s<64>(tint_result));
+        }
+    }
+    SECTION( "Karatsuba and Toom-3 kernels match schoolbook" ) {
+        TIMES(200) {
+            size_t n = mt32() % 400 + 5;
+            std::vector<impl_t> a(n), b(n), expected(2*n), kara(2*n), toom(2*n);
+            std::vector<impl_t> scratch(24*n + bigint::detail::mul_n_itch(n));
+
+            for(auto& s : a) s = (impl_t)mt64();
+            for(auto& s : b) s = (impl_t)mt64();
+            if(i % 4 == 0) std::fill(a.begin(), a.end(), (impl_t)-1);
+
+            bigint::detail::mul_basecase(expected.data(), a.data(), n, b.data(), n);
+            bigint::detail::mul_karatsuba_n(kara.data(), a.data(), b.data(), n, scratch.data());
+            bigint::detail::mul_toom3_n(toom.data(), a.data(), b.data(), n, scratch.data());
+
+            REQUIRE(kara == expected);
+            REQUIRE(toom == expected);
+        }
+    }
+    SECTION( "1024 x 8192 bit unbalanced operator*(bigint, bigint) with gmp" ) {
+        TIMES(100) {
+            uint64_t datain1[16];
+            uint64_t datain2[128];
+
+            for(auto& d : datain1) d = mt64();
+            for(auto& d : datain2) d = mt64();
+
+            bigint::s<1024> bint1;
+            bigint::s<8192> bint2;
+            REQUIRE(bint1.import(datain1, 16));
+            REQUIRE(bint2.import(datain2, 128));
+
+            mpz_t gmpint1;
+            mpz_t gmpint2;
+            mpz_init(gmpint1);
+            mpz_init(gmpint2);
+            mpz_import(gmpint1, 16, -1, sizeof(uint64_t), 0, 0, datain1);
+            mpz_import(gmpint2, 128, -1, sizeof(uint64_t), 0, 0, datain2);
+
+            bigint::s<9216> bint_result = bint1 * bint2;
+
+            mpz_t gmpint_result;
+            mpz_init(gmpint_result);
+            mpz_mul(gmpint_result, gmpint1, gmpint2);
+            uint64_t gmpint_result_data[144] = {};
+            size_t count = 0;
+            mpz_export(gmpint_result_data, &count, -1, sizeof(uint64_t), 0, 0,
+                       gmpint_result);
+
+            bigint::s<9216> gmpint_result_bint;
+            REQUIRE(gmpint_result_bint.import(gmpint_result_data, 144));
+
+            REQUIRE(gmpint_result_bint == bint_result);
+
+            mpz_clears(gmpint1, gmpint2, gmpint_result, NULL);
+        }
+    }
+    SECTION( "squaring kernels match schoolbook multiplication" ) {
+        TIMES(200) {
+            size_t n = mt32() % 400 + 5;
+            std::vector<impl_t> a(n), expected(2*n), base(2*n), kara(2*n), toom(2*n), ntt(2*n);
+            std::vector<impl_t> scratch(24*n + bigint::detail::mul_n_itch(n));
+
+            for(auto& s : a) s = (impl_t)mt64();
+            if(i % 4 == 0) std::fill(a.begin(), a.end(), (impl_t)-1);
+
+            bigint::detail::mul_basecase(expected.data(), a.data(), n, a.data(), n);
+            bigint::detail::sqr_basecase(base.data(), a.data(), n);
+            bigint::detail::sqr_karatsuba_n(kara.data(), a.data(), n, scratch.data());
+            bigint::detail::sqr_toom3_n(toom.data(), a.data(), n, scratch.data());
+            bigint::detail::mul_ntt(ntt.data(), a.data(), n, a.data(), n);
+
+            REQUIRE(base == expected);
+            REQUIRE(kara == expected);
+            REQUIRE(toom == expected);
+            REQUIRE(ntt == expected);
+        }
+    }
+    SECTION( "4096 bit range random square(bigint) and x * x with gmp" ) {
+        TIMES(100) {
+            uint64_t datain[64];
+
+            for(auto& d : datain) d = mt64();
+
+            bigint::s<4096> bint;
+            REQUIRE(bint.import(datain, 64));
+            bint.set_sign(i % 2);
+
+            mpz_t gmpint;
+            mpz_init(gmpint);
+            mpz_import(gmpint, 64, -1, sizeof(uint64_t), 0, 0, datain);
+
+            bigint::s<8192> bint_result = bigint::square(bint);
+            bigint::s<8192> bint_result_alias = bint * bint;
+
+            mpz_t gmpint_result;
+            mpz_init(gmpint_result);
+            mpz_mul(gmpint_result, gmpint, gmpint);
+            uint64_t gmpint_result_data[128] = {};
+            size_t count = 0;
+            mpz_export(gmpint_result_data, &count, -1, sizeof(uint64_t), 0, 0,
+                       gmpint_result);
+
+            bigint::s<8192> gmpint_result_bint;
+            REQUIRE(gmpint_result_bint.import(gmpint_result_data, 128));
+
+            REQUIRE(gmpint_result_bint == bint_result);
+            REQUIRE(gmpint_result_bint == bint_result_alias);
+
+            mpz_clears(gmpint, gmpint_result, NULL);
+        }
+    }
+    SECTION( "iterative FFT matches a direct DFT" ) {
+        for(size_t n = 1; n <= 512; n <<= 1) {
+            std::vector<std::complex<double>> x(n), expected(n);
+            for(auto& c : x) c = std::complex<double>((int)(mt32() % 512), (int)(mt32() % 512));
+
+            for(size_t k=0; k<n; k++)
+                for(size_t j=0; j<n; j++)
+                    expected[k] += x[j] * std::polar(1.0, 2 * M_PI * (double)((j * k) % n) / n);
+
+            auto result = x;
+            bigint::fft(result.begin(), result.end(), false);
+            for(size_t k=0; k<n; k++) REQUIRE(std::abs(result[k] - expected[k]) < 1e-6 * n * 512);
+
+            bigint::fft(result.begin(), result.end(), true);
+            for(size_t k=0; k<n; k++) REQUIRE(std::abs(result[k] / (double)n - x[k]) < 1e-9 * 512);
+        }
+    }
+    SECTION( "FFT products match the NTT" ) {
+        // all ones operands give the largest coefficients the chunk width allows
+        auto check = [](auto& a, auto& b, size_t i){
+            for(auto& seg : a._segments) seg = (impl_t)mt64();
+            for(auto& seg : b._segments) seg = (impl_t)mt64();
+            if(i % 2 == 0) for(auto& seg : a._segments) seg = (impl_t)-1;
+            if(i % 2 == 0) for(auto& seg : b._segments) seg = (impl_t)-1;
+            auto result = bigint::mul_fft(a, b);
+            auto squared = bigint::mul_fft(a, a);
+            std::vector<impl_t> expected(a.segments_count + b.segments_count), expected_sqr(2*a.segments_count);
+            bigint::detail::mul_ntt(expected.data(), a._segments.data(), a.segments_count,
+                                    b._segments.data(), b.segments_count);
+            bigint::detail::mul_ntt(expected_sqr.data(), a._segments.data(), a.segments_count,
+                                    a._segments.data(), a.segments_count);
+            REQUIRE(std::equal(expected.begin(), expected.end(), result._segments.begin()));
+            REQUIRE(std::equal(expected_sqr.begin(), expected_sqr.end(), squared._segments.begin()));
+            REQUIRE(result.multiplication_error_bound < 0.25);
+            REQUIRE(squared.multiplication_error_bound < 0.25);
+        };
+        TIMES(2) {
+            bigint::s<4096> a, b;
+            check(a, b, i);
+            bigint::s<65536> c;
+            bigint::s<16384> d;
+            check(c, d, i);
+        }
+        auto e = std::make_unique<bigint::s<1048576>>(), f = std::make_unique<bigint::s<1048576>>();
+        check(*e, *f, 0);
+    }
+    SECTION( "operator* and square reach the FFT at the default thresholds" ) {
+        // only mul_fft sets the error bound, so a nonzero one shows which tier ran
+        constexpr size_t fft_bits = BIGINT_FFT_THRESHOLD * impl_t_bit_sz;
+        auto a = std::make_unique<bigint::s<2*fft_bits>>();
+        auto b = std::make_unique<bigint::s<fft_bits>>();
+        TIMES(2) {
+            for(auto& seg : a->_segments) seg = (impl_t)(i == 0 ? -1 : mt64());
+            for(auto& seg : b->_segments) seg = (impl_t)(i == 0 ? -1 : mt64());
+            size_t an = a->segments_count, bn = b->segments_count;
+
+            auto product = *a * *b;
+            std::vector<impl_t> expected(an + bn);
+            bigint::detail::mul_ntt(expected.data(), a->_segments.data(), an, b->_segments.data(), bn);
+            REQUIRE(std::equal(expected.begin(), expected.end(), product._segments.begin()));
+            REQUIRE(product.multiplication_error_bound > 0);
+            REQUIRE(product.multiplication_error_bound < 0.25);
+
+            auto squared = bigint::square(*b);
+            auto self_product = *b * *b;
+            std::vector<impl_t> expected_sqr(2*bn);
+            bigint::detail::mul_ntt(expected_sqr.data(), b->_segments.data(), bn, b->_segments.data(), bn);
+            REQUIRE(std::equal(expected_sqr.begin(), expected_sqr.end(), squared._segments.begin()));
+            REQUIRE(squared == self_product);
+            REQUIRE(squared.multiplication_error_bound > 0);
+            REQUIRE(self_product.multiplication_error_bound > 0);
+        }
+    }
+    SECTION( "NTT kernel matches schoolbook" ) {
+        TIMES(50) {
+            size_t an = mt32() % 600 + 1;
+            size_t bn = mt32() % 600 + 1;
+            std::vector<impl_t> a(an), b(bn), expected(an + bn), result(an + bn);
+
+            for(auto& s : a) s = (impl_t)mt64();
+            for(auto& s : b) s = (impl_t)mt64();
+            if(i % 4 == 0) std::fill(a.begin(), a.end(), (impl_t)-1);
+            if(i % 8 == 0) std::fill(b.begin(), b.end(), (impl_t)-1);
+
+            bigint::detail::mul_basecase(expected.data(), a.data(), an, b.data(), bn);
+            bigint::detail::mul_ntt(result.data(), a.data(), an, b.data(), bn);
+
+            REQUIRE(result == expected);
+        }
+    }
+    SECTION( "thread pool kernels match the serial ones" ) {
+        bigint::detail::thread_pool pool(4);
+        auto random_limbs = [](size_t n){
+            std::vector<impl_t> v(n);
+            for(auto& s : v) s = (impl_t)mt64();
+            return v;
+        };
+
+        for(size_t n : { (size_t)BIGINT_PARALLEL_THRESHOLD, (size_t)3001 }) {
+            auto a = random_limbs(n), b = random_limbs(n);
+            std::vector<impl_t> expected(2*n), result(2*n), scratch(bigint::detail::mul_n_itch(n));
+
+            bigint::detail::mul_n(expected.data(), a.data(), b.data(), n, scratch.data());
+            bigint::detail::mul_n_par(result.data(), a.data(), b.data(), n, &pool);
+            REQUIRE(result == expected);
+
+            bigint::detail::sqr_n(expected.data(), a.data(), n, scratch.data());
+            bigint::detail::sqr_n_par(result.data(), a.data(), n, &pool);
+            REQUIRE(result == expected);
+        }
+
+        size_t an = 5*BIGINT_PARALLEL_THRESHOLD + 17, bn = BIGINT_PARALLEL_THRESHOLD;
+        auto a = random_limbs(an), b = random_limbs(bn);
+        std::vector<impl_t> expected(an + bn), result(an + bn), scratch(bigint::detail::mul_itch(bn));
+        bigint::detail::mul(expected.data(), a.data(), an, b.data(), bn, scratch.data());
+        bigint::detail::mul_par(result.data(), a.data(), an, b.data(), bn, &pool);
+        REQUIRE(result == expected);
+
+        auto c = random_limbs(40000), d = random_limbs(30000);
+        expected.assign(70000, 0); result.assign(70000, 0);
+        bigint::detail::mul_ntt(expected.data(), c.data(), 40000, d.data(), 30000);
+        bigint::detail::mul_ntt(result.data(), c.data(), 40000, d.data(), 30000, &pool);
+        REQUIRE(result == expected);
+
+        std::vector<std::complex<double>> x(1 << 15);
+        for(auto& v : x) v = std::complex<double>((int)(mt32() % 512), (int)(mt32() % 512));
+        auto y = x;
+        bigint::detail::fft(x.data(), x.size(), false);
+        bigint::detail::fft(y.data(), y.size(), false, &pool);
+        REQUIRE(x == y);
+
+        // through the operators, once set_threads lets them fork
+        bigint::s<262144> bint1, bint2;
+        for(size_t i=0; i<bint1.segments_count; i++){ bint1._segments[i] = (impl_t)mt64(); bint2._segments[i] = (impl_t)mt64(); }
+        auto serial = bint1 * bint2;
+        bigint::set_threads(4);
+        REQUIRE(bigint::threads() == 4);
+        auto parallel = bint1 * bint2;
+        bigint::Dynamic dint = bigint::Dynamic(bint1) * bigint::Dynamic(bint2);
+        bigint::set_threads(1);
+        REQUIRE(parallel == serial);
+        REQUIRE(dint == bigint::Dynamic(serial));
+    }
     SECTION( "1048576 bit range random operator*(bigint, bigint) with gmp" ) {
-        TIMES(0) {
+        TIMES(1) {
             uint64_t * datain1 = new uint64_t[16384];
             uint64_t * datain2 = new uint64_t[16384];
 
@@ -241,22 +616,846 @@ TEST_CASE( "Multiplication" ) {
             mpz_import(gmpint2, 16384, -1, sizeof(uint64_t), 0, 0, datain2);
 
             bigint::s<2097152ull> * bint_result = new bigint::s<2097152ull>();
-            // (*bint_result) = (*bint1) * (*bint2);
+            (*bint_result) = (*bint1) * (*bint2);
 
             mpz_t gmpint_result;
             mpz_init(gmpint_result);
             mpz_mul(gmpint_result, gmpint1, gmpint2);
-            uint64_t * gmpint_result_data = new uint64_t[32768];
+            uint64_t * gmpint_result_data = new uint64_t[32768]();
+            size_t count = 0;
+            mpz_export(gmpint_result_data, &count, -1, sizeof(uint64_t), 0, 0,
+                       gmpint_result);
+
+            bigint::s<2097152ull> * gmpint_result_bint = new bigint::s<2097152ull>();
+            REQUIRE(gmpint_result_bint->import(gmpint_result_data, 32768));
+
+            REQUIRE(*gmpint_result_bint == *bint_result);
+
+            mpz_clears(gmpint1, gmpint2, gmpint_result, NULL);
+            delete[] datain1; delete[] datain2; delete[] gmpint_result_data;
+            delete bint1; delete bint2; delete bint_result; delete gmpint_result_bint;
+        }
+    }
+}
+
+TEST_CASE( "Division" ) {
+
+    SECTION( "signed 64 bit range operator/ and operator%" ) {
+        TIMES(1000) {
+            int64_t tint1 = (int64_t)(mt64() >> 1) * (i % 2 ? -1 : 1);
+            int64_t tint2 = (int32_t)mt32();
+            if(i % 3 == 0) tint2 = (int64_t)(mt64() >> (mt32() % 63 + 1));
+            if(tint2 == 0) tint2 = 7;
+
+            bigint::s<64> bint1(tint1);
+            bigint::s<64> bint2(tint2);
+
+            REQUIRE((bint1 / bint2) == bigint::s<64>(tint1 / tint2));
+            REQUIRE((bint1 % bint2) == bigint::s<64>(tint1 % tint2));
+            REQUIRE((bint1 / tint2) == bigint::s<64>(tint1 / tint2));
+            REQUIRE((bint1 % tint2) == bigint::s<64>(tint1 % tint2));
+
+            auto [q, r] = bigint::divmod(bint1, bint2);
+            REQUIRE(q == bigint::s<64>(tint1 / tint2));
+            REQUIRE(r == bigint::s<64>(tint1 % tint2));
+        }
+    }
+    SECTION( "4096 bit by random width divisor with gmp" ) {
+        auto to_bigint = [](const mpz_t x){
+            uint64_t data[64] = {};
+            size_t count = 0;
+            mpz_export(data, &count, -1, sizeof(uint64_t), 0, 0, x);
+            bigint::s<4096> ret;
+            REQUIRE(ret.import(data, 64));
+            if(mpz_sgn(x) < 0) ret.toggle_sign();
+            return ret;
+        };
+
+        TIMES(500) {
+            uint64_t datain1[64];
+            uint64_t datain2[32] = {};
+            size_t dn = mt32() % 32 + 1;
+
+            for(auto& d : datain1) d = mt64();
+            for(size_t j = 0; j < dn; j++) datain2[j] = mt64();
+            if(datain2[dn-1] == 0) datain2[dn-1] = 1;
+            // quotient digit estimates that hit B - 1 and need the add back
+            if(i % 5 == 0){
+                for(auto& d : datain1) d = (uint64_t)-1;
+                for(size_t j = 0; j+1 < dn; j++) datain2[j] = 0;
+                datain2[dn-1] = (uint64_t)1 << 63;
+            }
+            if(i % 7 == 0) for(size_t j = 0; j < dn; j++) datain1[64 - dn + j] = datain2[j];
+            if(i % 11 == 0) datain2[dn-1] = mt64() >> (mt32() % 64);
+            if(datain2[dn-1] == 0) datain2[dn-1] = 3;
+
+            bigint::s<4096> bint1;
+            bigint::s<2048> bint2;
+            REQUIRE(bint1.import(datain1, 64));
+            REQUIRE(bint2.import(datain2, 32));
+            if(i % 2) bint1.toggle_sign();
+            if(i % 3) bint2.toggle_sign();
+
+            mpz_t gmpint1, gmpint2, gmpq, gmpr;
+            mpz_inits(gmpint1, gmpint2, gmpq, gmpr, NULL);
+            mpz_import(gmpint1, 64, -1, sizeof(uint64_t), 0, 0, datain1);
+            mpz_import(gmpint2, 32, -1, sizeof(uint64_t), 0, 0, datain2);
+            if(bint1.is_negative()) mpz_neg(gmpint1, gmpint1);
+            if(bint2.is_negative()) mpz_neg(gmpint2, gmpint2);
+            mpz_tdiv_qr(gmpq, gmpr, gmpint1, gmpint2);
+
+            auto [q, r] = bigint::divmod(bint1, bint2);
+            REQUIRE(q == to_bigint(gmpq));
+            REQUIRE(r == to_bigint(gmpr));
+            REQUIRE((bint1 / bint2) == q);
+            REQUIRE((bint1 % bint2) == r);
+
+            mpz_clears(gmpint1, gmpint2, gmpq, gmpr, NULL);
+        }
+    }
+    SECTION( "65536 bit by divisors above BIGINT_DIV_DC_THRESHOLD with gmp" ) {
+        auto to_bigint = [](const mpz_t x){
+            std::vector<uint64_t> data(1024);
             size_t count = 0;
-            // mpz_export(gmpint_result_data, &count, -1, sizeof(uint64_t), 0, 0,
-            //            gmpint_result);
+            mpz_export(data.data(), &count, -1, sizeof(uint64_t), 0, 0, x);
+            bigint::s<65536> ret;
+            REQUIRE(ret.import(data.data(), 1024));
+            if(mpz_sgn(x) < 0) ret.toggle_sign();
+            return ret;
+        };
+
+        TIMES(20) {
+            std::vector<uint64_t> datain1(1024), datain2(512);
+            size_t dn = mt32() % 448 + 64;
+
+            for(auto& d : datain1) d = mt64();
+            for(size_t j = 0; j < dn; j++) datain2[j] = mt64();
+            if(i % 4 == 0) for(auto& d : datain1) d = (uint64_t)-1;
+            if(i % 4 == 1) datain2[dn-1] = 1;
+            if(datain2[dn-1] == 0) datain2[dn-1] = 3;
+
+            bigint::s<65536> bint1;
+            bigint::s<32768> bint2;
+            REQUIRE(bint1.import(datain1.data(), 1024));
+            REQUIRE(bint2.import(datain2.data(), 512));
+            if(i % 2) bint2.toggle_sign();
+
+            mpz_t gmpint1, gmpint2, gmpq, gmpr;
+            mpz_inits(gmpint1, gmpint2, gmpq, gmpr, NULL);
+            mpz_import(gmpint1, 1024, -1, sizeof(uint64_t), 0, 0, datain1.data());
+            mpz_import(gmpint2, 512, -1, sizeof(uint64_t), 0, 0, datain2.data());
+            if(bint2.is_negative()) mpz_neg(gmpint2, gmpint2);
+            mpz_tdiv_qr(gmpq, gmpr, gmpint1, gmpint2);
+
+            auto [q, r] = bigint::divmod(bint1, bint2);
+            REQUIRE(q == to_bigint(gmpq));
+            REQUIRE(r == to_bigint(gmpr));
+
+            mpz_clears(gmpint1, gmpint2, gmpq, gmpr, NULL);
+        }
+    }
+}
+
+TEST_CASE( "Dynamic" ) {
+
+    SECTION( "signed 64 bit range arithmetic" ) {
+        TIMES(1000) {
+            int64_t tint1 = (int32_t)mt32();
+            int64_t tint2 = (int32_t)mt32();
+
+            bigint::Dynamic dint1(tint1);
+            bigint::Dynamic dint2(tint2);
+
+            REQUIRE((dint1 + dint2) == bigint::Dynamic(tint1 + tint2));
+            REQUIRE((dint1 - dint2) == bigint::Dynamic(tint1 - tint2));
+            REQUIRE((dint1 * dint2) == bigint::Dynamic(tint1 * tint2));
+            REQUIRE((dint1 < dint2) == (tint1 < tint2));
+            REQUIRE((dint1 - dint1).is_zero());
+            REQUIRE((dint1 * dint2).to_signed<64>() == bigint::s<64>(tint1 * tint2));
+        }
+    }
+    SECTION( "limbs grow only when a carry runs out of room" ) {
+        bigint::Dynamic dint((uint64_t)-1);
+        REQUIRE(dint.segments_count() == 64 / impl_t_bit_sz);
+
+        dint += 1;
+        REQUIRE(dint.segments_count() == 64 / impl_t_bit_sz + 1);
+        dint -= 1;
+        REQUIRE(dint.segments_count() == 64 / impl_t_bit_sz);
+        REQUIRE(dint == bigint::Dynamic((uint64_t)-1));
+
+        bigint::Dynamic acc;
+        TIMES(200) acc += dint;
+        REQUIRE(acc.segments_count() == 64 / impl_t_bit_sz + 1);
+    }
+    SECTION( "matches Signed<N> on random unbalanced operands" ) {
+        TIMES(100) {
+            uint64_t datain1[64];
+            uint64_t datain2[16];
+
+            for(auto& d : datain1) d = mt64();
+            for(auto& d : datain2) d = mt64();
+
+            bigint::s<4096> bint1;
+            bigint::s<1024> bint2;
+            REQUIRE(bint1.import(datain1, 64));
+            REQUIRE(bint2.import(datain2, 16));
+            if(i % 2) bint2.toggle_sign();
+
+            bigint::Dynamic dint1(bint1);
+            bigint::Dynamic dint2(bint2);
+
+            auto bint_result = bint1 * bint2 + bint1 - bint2;
+            bigint::Dynamic dint_result = dint1 * dint2 + dint1 - dint2;
 
-            log(count, "count");
+            REQUIRE(bigint::Dynamic(bint_result) == dint_result);
+            REQUIRE(dint_result.to_signed<5122>() == bint_result);
+            REQUIRE(bigint::Dynamic(square(bint1)) == dint1 * dint1);
+            REQUIRE((dint2 < dint1) == (bint2 < bint1));
+        }
+    }
+}
+
+TEST_CASE( "Montgomery" ) {
+
+    SECTION( "single limb modulus against 128 bit arithmetic" ) {
+        TIMES(1000) {
+            uint64_t m = (mt64() >> (mt32() % 60)) | 1;
+            if(m == 1) m = 3;
+            uint64_t a = mt64() % m, b = mt64() % m;
+
+            __extension__ typedef unsigned __int128 u128;
+            bigint::Montgomery<64> mont{bigint::s<64>(m)};
+            auto am = mont.to_mont(bigint::s<64>(a));
+            auto bm = mont.to_mont(bigint::s<64>(b));
+
+            REQUIRE(mont.from_mont(am) == bigint::s<64>(a));
+            REQUIRE(mont.from_mont(mont.mul(am, bm)) == bigint::s<64>((uint64_t)((u128)a * b % m)));
+            REQUIRE(mont.from_mont(mont.sqr(am)) == bigint::s<64>((uint64_t)((u128)a * a % m)));
+            REQUIRE(mont.from_mont(mont.add(am, bm)) == bigint::s<64>((uint64_t)(((u128)a + b) % m)));
+            REQUIRE(mont.from_mont(mont.sub(am, bm)) == bigint::s<64>((a >= b) ? a - b : m - (b - a)));
+            REQUIRE(mont.from_mont(mont.one()) == bigint::s<64>(1));
+        }
+    }
+    SECTION( "2048 bit random odd modulus against operator%" ) {
+        TIMES(100) {
+            uint64_t datam[32], dataa[32], datab[32];
+
+            for(auto& d : datam) d = mt64();
+            for(auto& d : dataa) d = mt64();
+            for(auto& d : datab) d = mt64();
+            datam[0] |= 1;
+            // short moduli leave high zero limbs below R
+            if(i % 4 == 0) for(size_t j = 20; j < 32; j++) datam[j] = 0;
+            if(i % 4 == 1) datam[31] = (uint64_t)-1;
+
+            bigint::s<2048> m, a, b;
+            REQUIRE(m.import(datam, 32));
+            REQUIRE(a.import(dataa, 32));
+            REQUIRE(b.import(datab, 32));
+            if(i % 3 == 0) a.toggle_sign();
+
+            bigint::Montgomery<2048> mont(m);
+            auto am = mont.to_mont(a);
+            auto bm = mont.to_mont(b);
+
+            bigint::s<2048> ar = a % m;
+            if(ar.is_negative()) ar = ar + m;
+            bigint::s<2048> br = b % m;
+
+            REQUIRE(mont.from_mont(am) == ar);
+            REQUIRE(mont.from_mont(mont.mul(am, bm)) == (ar * br) % m);
+            REQUIRE(mont.from_mont(mont.sqr(am)) == (ar * ar) % m);
+            REQUIRE(mont.from_mont(mont.add(am, bm)) == (ar + br) % m);
+            REQUIRE(mont.from_mont(mont.sub(am, bm)) == ((ar - br) % m + m) % m);
+        }
+    }
+}
+
+TEST_CASE( "Barrett" ) {
+
+    SECTION( "single limb modulus against 128 bit arithmetic" ) {
+        TIMES(1000) {
+            uint64_t m = mt64() >> (mt32() % 63);
+            if(m == 0) m = 1;
+            uint64_t a = mt64(), b = mt64();
+
+            __extension__ typedef unsigned __int128 u128;
+            bigint::Barrett<64> red{bigint::s<64>(m)};
+            REQUIRE(red.reduce(bigint::s<64>(a)) == bigint::s<64>(a % m));
+            REQUIRE(red.mul(bigint::s<64>(a), bigint::s<64>(b)) == bigint::s<64>((uint64_t)((u128)a * b % m)));
+            REQUIRE(red.one() == bigint::s<64>(1 % m));
+        }
+    }
+    SECTION( "2048 bit products against operator%" ) {
+        TIMES(100) {
+            uint64_t datam[32], dataa[32], datab[32];
+
+            for(auto& d : datam) d = mt64();
+            for(auto& d : dataa) d = mt64();
+            for(auto& d : datab) d = mt64();
+            // short moduli, a power of the limb base and an all ones top limb
+            if(i % 5 == 0) for(size_t j = 1 + mt32() % 31; j < 32; j++) datam[j] = 0;
+            if(i % 5 == 1){ std::fill(datam, datam + 32, 0); datam[mt32() % 32] = 1; }
+            if(i % 5 == 2) datam[31] = (uint64_t)-1;
+
+            bigint::s<2048> m, a, b;
+            REQUIRE(m.import(datam, 32));
+            REQUIRE(a.import(dataa, 32));
+            REQUIRE(b.import(datab, 32));
+            if(i % 3 == 0) a.toggle_sign();
+
+            bigint::Barrett<2048> red(m);
+            bigint::s<4096> p = a * b;
+            bigint::s<2048> expected = p % m;
+            if(expected.is_negative()) expected = expected + m;
+
+            REQUIRE(red.reduce(p) == expected);
+            REQUIRE(red.reduce(b) == b % m);
+        }
+    }
+}
+
+TEST_CASE( "Modular exponentiation" ) {
+
+    SECTION( "64 bit range powmod against square and multiply" ) {
+        TIMES(300) {
+            uint64_t m = mt64() >> (mt32() % 62);
+            if(m == 0) m = 2;
+            uint64_t b = mt64(), e = mt64() >> (mt32() % 64);
+            if(i % 10 == 0) e = 0;
 
-            // bigint::s<2097152> gmpint_result_bint = bint1 * bint2;
-            // REQUIRE(gmpint_result_bint.import(gmpint_result_data, 32768));
+            __extension__ typedef unsigned __int128 u128;
+            u128 expected = 1 % m, x = b % m;
+            for(uint64_t k = e; k; k >>= 1){
+                if(k & 1) expected = expected * x % m;
+                x = x * x % m;
+            }
+
+            auto bint_result = bigint::powmod(bigint::s<64>(b), bigint::s<64>(e), bigint::s<64>(m));
+            REQUIRE(bint_result == bigint::s<64>((uint64_t)expected));
+        }
+    }
+    SECTION( "2048 bit powmod with gmp" ) {
+        TIMES(20) {
+            uint64_t datab[32], datae[32], datam[32];
+
+            for(auto& d : datab) d = mt64();
+            for(auto& d : datae) d = mt64();
+            for(auto& d : datam) d = mt64();
+            // even moduli take the division fallback
+            if(i % 2) datam[0] |= 1;
+            else      datam[0] &= ~(uint64_t)1;
+            if(i % 5 == 0) for(size_t j = 2; j < 32; j++) datae[j] = 0;
+
+            bigint::s<2048> b, e, m;
+            REQUIRE(b.import(datab, 32));
+            REQUIRE(e.import(datae, 32));
+            REQUIRE(m.import(datam, 32));
+            if(i % 3 == 0) b.toggle_sign();
+
+            mpz_t gb, ge, gm, gr;
+            mpz_inits(gb, ge, gm, gr, NULL);
+            mpz_import(gb, 32, -1, sizeof(uint64_t), 0, 0, datab);
+            mpz_import(ge, 32, -1, sizeof(uint64_t), 0, 0, datae);
+            mpz_import(gm, 32, -1, sizeof(uint64_t), 0, 0, datam);
+            if(b.is_negative()) mpz_neg(gb, gb);
+            mpz_powm(gr, gb, ge, gm);
+
+            uint64_t datar[32] = {};
+            size_t count = 0;
+            mpz_export(datar, &count, -1, sizeof(uint64_t), 0, 0, gr);
+            bigint::s<2048> gmpint_result;
+            REQUIRE(gmpint_result.import(datar, 32));
+
+            REQUIRE(bigint::powmod(b, e, m) == gmpint_result);
+            mpz_clears(gb, ge, gm, gr, NULL);
+        }
+    }
+}
+
+
+TEST_CASE( "Constant time" ) {
+
+    SECTION( "512 bit magnitudes against the variable time operators" ) {
+        TIMES(500) {
+            uint64_t dataa[8], datab[8];
+            for(auto& d : dataa) d = mt64();
+            for(auto& d : datab) d = mt64();
+            // equal and nearly equal operands
+            if(i % 5 == 0) std::copy(dataa, dataa + 8, datab);
+            if(i % 5 == 1){ std::copy(dataa, dataa + 8, datab); datab[mt32() % 8] ^= 1; }
+
+            bigint::s<512> a, b;
+            REQUIRE(a.import(dataa, 8));
+            REQUIRE(b.import(datab, 8));
+
+            REQUIRE(bigint::ct::add(a, b) == a + b);
+            REQUIRE(bigint::ct::sub(a, b) == a - b);
+            REQUIRE(bigint::ct::cmp(a, b) == ((a < b) ? -1 : (a > b) ? 1 : 0));
+            REQUIRE(bigint::ct::equal(a, b) == (a == b));
+            REQUIRE(bigint::ct::select(true,  a, b) == a);
+            REQUIRE(bigint::ct::select(false, a, b) == b);
+        }
+    }
+    SECTION( "1024 bit Montgomery product and powmod against the variable time ones" ) {
+        TIMES(30) {
+            uint64_t datab[16], datae[16], datam[16];
+            for(auto& d : datab) d = mt64();
+            for(auto& d : datae) d = mt64();
+            for(auto& d : datam) d = mt64();
+            datam[0] |= 1;
+            if(i % 4 == 0) for(size_t j = 10; j < 16; j++) datam[j] = 0;
+            if(i % 6 == 1) std::fill(datae, datae + 16, 0);
+            if(i % 6 == 2) std::fill(datae, datae + 16, (uint64_t)-1);
+            if(i % 6 == 3){ std::fill(datae, datae + 16, 0); datae[0] = 1; }
+
+            bigint::s<1024> b, e, m;
+            REQUIRE(b.import(datab, 16));
+            REQUIRE(e.import(datae, 16));
+            REQUIRE(m.import(datam, 16));
+            b = b % m;
+            if(i % 6 == 4) b = m - bigint::s<8>(1);
+            if(i % 6 == 5) b = bigint::s<8>(0);
+
+            bigint::Montgomery<1024> mont(m);
+            auto bm = mont.to_mont(b);
+            REQUIRE(bigint::ct::mul(mont, bm, bm) == mont.mul(bm, bm));
+            REQUIRE(bigint::ct::powmod(b, e, mont) == bigint::powmod(b, e, m));
+        }
+    }
+}
+
+TEST_CASE( "Decimal conversion" ) {
+
+    SECTION( "64 bit values against std::to_string" ) {
+        TIMES(1000) {
+            int64_t val = (int64_t)(mt64() >> (mt32() % 64));
+            if(i % 2) val = -val;
+            if(i == 0) val = 0;
+
+            bigint::s<64> bint(val);
+            REQUIRE(bint.to_decimal() == std::to_string(val));
+
+            bigint::s<64> parsed;
+            REQUIRE(parsed.from_decimal(std::to_string(val)));
+            REQUIRE(parsed == bint);
+        }
+    }
+    SECTION( "malformed and oversized input" ) {
+        bigint::s<64> bint;
+        REQUIRE(!bint.from_decimal(""));
+        REQUIRE(!bint.from_decimal("-"));
+        REQUIRE(!bint.from_decimal("12a4"));
+        REQUIRE(!bint.from_decimal(" 1"));
+        REQUIRE(bint.is_zero());
+        REQUIRE(bint.from_decimal("+0042"));
+        REQUIRE(bint == bigint::s<64>(42));
+        REQUIRE(bint.from_decimal("-0"));
+        REQUIRE((bint.is_zero() && bint.is_positive()));
+        REQUIRE(bint.from_decimal("18446744073709551616"));
+        REQUIRE(bint.was_truncated());
+    }
+    SECTION( "65536 bit values with gmp" ) {
+        TIMES(4) {
+            uint64_t data[1024];
+            for(auto& d : data) d = mt64();
+            // shorter values and runs of zero digits in the middle
+            size_t len = 1024 >> (i % 4);
+            if(i == 3) for(size_t j = 100; j < 400; j++) data[j] = 0;
+
+            bigint::s<65536> bint;
+            REQUIRE(bint.import(data, len));
+            if(i % 2) bint.toggle_sign();
+
+            mpz_t g;
+            mpz_init(g);
+            mpz_import(g, len, -1, sizeof(uint64_t), 0, 0, data);
+            if(i % 2) mpz_neg(g, g);
+            std::string expected(mpz_sizeinbase(g, 10) + 2, '\0');
+            mpz_get_str(&expected[0], 10, g);
+            expected.resize(std::strlen(expected.c_str()));
+
+            REQUIRE(bint.to_decimal() == expected);
+            bigint::s<65536> parsed;
+            REQUIRE(parsed.from_decimal(expected));
+            REQUIRE(parsed == bint);
+            mpz_clear(g);
+        }
+    }
+}
+
+TEST_CASE( "Hex and binary conversion" ) {
+
+    SECTION( "64 bit values against printf and bitset" ) {
+        TIMES(1000) {
+            uint64_t val = mt64() >> (mt32() % 64);
+            bool negative = i % 2;
+            if(i == 0) val = 0;
+
+            bigint::s<64> bint(val);
+            if(negative) bint.toggle_sign();
+
+            char hex[32];
+            std::snprintf(hex, sizeof(hex), "%s%llx", (negative && val) ? "-" : "", (unsigned long long)val);
+            std::string bin = std::bitset<64>(val).to_string();
+            bin = bin.substr(std::min(bin.find('1'), (size_t)63));
+            if(negative && val) bin = "-" + bin;
+
+            REQUIRE(bint.to_hex() == hex);
+            REQUIRE(bint.to_binary() == bin);
+            REQUIRE(bint.binary_string() == std::bitset<64>(val).to_string());
+
+            bigint::s<64> parsed;
+            REQUIRE(parsed.from_hex(hex));
+            REQUIRE(parsed == bint);
+            REQUIRE(parsed.from_binary(bin));
+            REQUIRE(parsed == bint);
+        }
+    }
+    SECTION( "caller buffers and malformed input" ) {
+        bigint::s<128> bint(0xabcdefull);
+        char buf[8] = "xxxxxxx";
+        REQUIRE(bint.to_hex(buf, 5) == 6);
+        REQUIRE(std::string(buf) == "xxxxxxx");
+        REQUIRE(bint.to_hex(buf, 6) == 6);
+        REQUIRE(std::string(buf, 6) == "abcdef");
+
+        REQUIRE(!bint.from_hex(""));
+        REQUIRE(!bint.from_hex("-"));
+        REQUIRE(!bint.from_hex("12g4"));
+        REQUIRE(!bint.from_hex("0123456789abcdef:123456789ABCDEF"));
+        REQUIRE(!bint.from_hex("0123456789abcdef0123456789ABCD\xc6" "F"));
+        REQUIRE(!bint.from_hex("0123456789abcdef0123456789ABCDG0"));
+        REQUIRE(!bint.from_binary("10201"));
+        REQUIRE(!bint.from_binary("1111111111111111111111111111111111111111111111111111111111111111/"));
+        REQUIRE(bint.is_zero());
+        bigint::s<128> expected(0xffaa);
+        expected.toggle_sign();
+        REQUIRE(bint.from_hex("-00FfaA"));
+        REQUIRE(bint == expected);
+        REQUIRE(bint.from_hex("1" + std::string(32, '0')));
+        REQUIRE(bint.was_truncated());
+        REQUIRE(bint.from_binary("1" + std::string(128, '0')));
+        REQUIRE(bint.was_truncated());
+    }
+    SECTION( "4096 bit values with gmp" ) {
+        TIMES(50) {
+            uint64_t data[64];
+            for(auto& d : data) d = mt64();
+            size_t len = 1 + mt32() % 64;
+            data[len - 1] >>= mt32() % 64;
+
+            bigint::s<4096> bint;
+            REQUIRE(bint.import(data, len));
+            if(i % 2) bint.toggle_sign();
+
+            mpz_t g;
+            mpz_init(g);
+            mpz_import(g, len, -1, sizeof(uint64_t), 0, 0, data);
+            if(i % 2) mpz_neg(g, g);
+            for(int base : {16, 2}){
+                std::string expected(mpz_sizeinbase(g, base) + 2, '\0');
+                mpz_get_str(&expected[0], base, g);
+                expected.resize(std::strlen(expected.c_str()));
+
+                bigint::s<4096> parsed;
+                if(base == 16){
+                    REQUIRE(bint.to_hex() == expected);
+                    REQUIRE(parsed.from_hex(expected));
+                } else {
+                    REQUIRE(bint.to_binary() == expected);
+                    REQUIRE(parsed.from_binary(expected));
+                }
+                REQUIRE(parsed == bint);
+            }
+            mpz_clear(g);
+        }
+    }
+}
+
+TEST_CASE( "Import and export" ) {
+
+    SECTION( "every word order, byte order and word size with gmp" ) {
+        TIMES(200) {
+            uint8_t bytes[256];
+            for(auto& b : bytes) b = (uint8_t)mt32();
+            int order  = (i % 2) ? 1 : -1;
+            int endian = (int)(i / 2 % 3) - 1;
+            size_t size = std::vector<size_t>{1, 2, 3, 4, 8, 16}[i / 6 % 6];
+            size_t count = (1 + mt32() % 128) / size + 1;
+            if(count * size > sizeof(bytes)) count = sizeof(bytes) / size;
+
+            mpz_t g;
+            mpz_init(g);
+            mpz_import(g, count, order, size, endian, 0, bytes);
+
+            bigint::s<2048> bint;
+            bint.toggle_sign();
+            REQUIRE(bint.import(bytes, count, order, size, endian));
+            REQUIRE(bint.is_positive());
+            size_t gcount = 0;
+            uint64_t limbs[32] = {};
+            mpz_export(limbs, &gcount, -1, sizeof(uint64_t), 0, 0, g);
+            bigint::s<2048> expected;
+            REQUIRE(expected.import(limbs, 32));
+            REQUIRE(bint == expected);
+
+            uint8_t out[256] = {}, gout[256] = {};
+            size_t words = bint.export_to(out, order, size, endian);
+            mpz_export(gout, &gcount, order, size, endian, 0, g);
+            REQUIRE(words == gcount);
+            REQUIRE(std::equal(out, out + words * size, gout));
+            mpz_clear(g);
+        }
+    }
+    SECTION( "imports replace the previous value and report what does not fit" ) {
+        uint64_t data[4] = { 5, 0, 0, 0 };
+        bigint::s<256> bint;
+        REQUIRE(bint.from_hex("-ffffffffffffffffffffffffffffffffffff"));
+        REQUIRE(bint.import(data, 4));
+        REQUIRE(bint == bigint::s<256>(5));
+
+        bigint::s<128> narrow;
+        REQUIRE(narrow.import(data, 4));
+        REQUIRE(narrow == bigint::s<128>(5));
+        data[3] = 1;
+        REQUIRE(!narrow.import(data, 4));
+        REQUIRE(narrow.was_truncated());
+
+        uint32_t words[3] = { 1, 2, 3 };
+        REQUIRE(bint.import(words, 3));
+        REQUIRE(bint.to_hex() == "300000002" "00000001");
+        REQUIRE(bint.export_count(1) == 9);
+        REQUIRE(bigint::s<64>(0).export_count(8) == 0);
+    }
+    SECTION( "views read external limbs in place" ) {
+        alignas(8) uint64_t data[8];
+        for(auto& d : data) d = mt64();
+        data[6] = data[7] = 0;
+        auto* limbs = reinterpret_cast<const impl_t*>(data);
+        size_t count = 8 * sizeof(uint64_t) / sizeof(impl_t);
+
+        bigint::View view(limbs, count, true);
+        REQUIRE(view.segments_count() == count * 6 / 8);
+        REQUIRE(view.limbs().data == limbs);
+
+        bigint::s<512> bint;
+        REQUIRE(bint.import(data, 8));
+        bint.toggle_sign();
+        REQUIRE(bigint::s<512>(view) == bint);
+        REQUIRE(bigint::Dynamic(view) == bigint::Dynamic(bint));
+        REQUIRE(bigint::s<256>(view).was_truncated());
+        REQUIRE(bigint::View(limbs, 0, true).is_positive());
+    }
+}
+
+TEST_CASE( "Batch" ) {
+    using bigint::detail::batch_isa;
+    const batch_isa detected = bigint::detail::batch_isa_detect();
+
+    auto random_s256 = [](size_t i){
+        uint64_t data[4];
+        for(auto& d : data) d = mt64();
+        // extremes carry through every limb
+        if(i % 7 == 0) for(auto& d : data) d = (uint64_t)-1;
+        if(i % 11 == 0) for(size_t j=1; j<4; j++) data[j] = 0;
+        bigint::s<256> bint;
+        bint.import(data, 4);
+        if(i % 3 == 0) bint.toggle_sign();
+        return bint;
+    };
+
+    for(batch_isa isa : { batch_isa::generic, batch_isa::avx2, batch_isa::avx512 }) {
+        if(isa > detected) continue;
+        bigint::detail::batch_path() = isa;
+
+        SECTION( "add, sub, compare and limb products match Signed, path " + std::to_string((int)isa) ) {
+            const size_t count = 203;
+            bigint::batch<256> a(count);
+            bigint::Batch<128> b(count);
+            std::vector<bigint::s<256>> sa(count);
+            std::vector<bigint::s<128>> sb(count);
+            for(size_t i=0; i<count; i++){
+                sa[i] = random_s256(i);
+                sb[i] = random_s256(i + 1);
+                if(i % 5 == 0) sb[i] = sa[i];
+                a.set(i, sa[i]);
+                b.set(i, sb[i]);
+                REQUIRE(a.get(i) == sa[i]);
+            }
+
+            auto sum = a + b;
+            auto diff = b - a;
+            auto order = bigint::cmp(a, b);
+            impl_t v = (impl_t)mt64();
+            auto scaled = a * v;
+            for(size_t i=0; i<count; i++){
+                REQUIRE(sum.get(i) == sa[i] + sb[i]);
+                REQUIRE(diff.get(i) == sb[i] - sa[i]);
+                REQUIRE(order[i] == ((sa[i] < sb[i]) ? -1 : (sa[i] == sb[i]) ? 0 : 1));
+                REQUIRE(scaled.get(i) == sa[i] * bigint::s<impl_t_bit_sz>(v));
+            }
+
+            a.resize(count + 70);
+            REQUIRE(a.get(count - 1) == sa[count - 1]);
+            REQUIRE(a.get(count + 69).is_zero());
+            a.resize(10);
+            REQUIRE(a.get(9) == sa[9]);
+        }
+        SECTION( "Montgomery products match Montgomery<N>::mul, path " + std::to_string((int)isa) ) {
+            const size_t count = 77;
+            bigint::s<256> m = random_s256(1);
+            m.set_sign(false);
+            m._segments[0] |= 1;
+            bigint::Montgomery<256> mont(m);
+
+            bigint::batch<256> a(count), b(count);
+            std::vector<bigint::s<256>> sa(count), sb(count);
+            for(size_t i=0; i<count; i++){
+                sa[i] = mont.to_mont(random_s256(2*i));
+                sb[i] = mont.to_mont(random_s256(2*i + 1));
+                if(i == 0) sa[i] = bigint::s<256>(0);
+                a.set(i, sa[i]);
+                b.set(i, sb[i]);
+            }
+            auto prod = bigint::mul(mont, a, b);
+            for(size_t i=0; i<count; i++) REQUIRE(prod.get(i) == mont.mul(sa[i], sb[i]));
+        }
+    }
+    bigint::detail::batch_path() = detected;
+}
+
+TEST_CASE( "Compound assignment" ) {
+    auto random_s = [](auto& bint, size_t i){
+        for(auto& seg : bint._segments) seg = (impl_t)mt64();
+        if(i % 7 == 0) for(auto& seg : bint._segments) seg = (impl_t)-1;
+        if(i % 5 == 0) for(size_t j=bint.segments_count/2; j<bint.segments_count; j++) bint._segments[j] = 0;
+        bint.set_sign(i % 3 == 0);
+    };
+
+    // in place results, signs and TRUNCATED flags against assigning the widened eager result
+    auto check = [](const auto& a, const auto& b){
+        using S = std::decay_t<decltype(a)>;
+        S x;
+        x = a; x += b; REQUIRE(x == S(a + b)); REQUIRE(x.get_flags() == S(a + b).get_flags());
+        x = a; x -= b; REQUIRE(x == S(a - b)); REQUIRE(x.get_flags() == S(a - b).get_flags());
+        x = a; x *= b; REQUIRE(x == S(a * b)); REQUIRE(x.was_truncated() == S(a * b).was_truncated());
+        x = a; x &= b; REQUIRE(x == S(a & b)); REQUIRE(x.get_flags() == S(a & b).get_flags());
+        x = a; x |= b; REQUIRE(x == S(a | b)); REQUIRE(x.get_flags() == S(a | b).get_flags());
+        x = a; x ^= b; REQUIRE(x == S(a ^ b)); REQUIRE(x.get_flags() == S(a ^ b).get_flags());
+    };
+
+    SECTION( "signed operands narrower, as wide and wider than the target" ) {
+        TIMES(100) {
+            bigint::s<512> a, b;
+            bigint::s<192> c;
+            bigint::s<1024> d;
+            random_s(a, i); random_s(b, i + 1); random_s(c, i + 2); random_s(d, i + 3);
+            if(i % 4 == 0) b = a;
+            if(i % 8 == 0) b.toggle_sign();
+            check(a, b);
+            check(a, c);
+            check(a, d);
+            check(c, a);
+
+            int64_t v = (int64_t)mt64();
+            bigint::s<512> x = a;
+            x += v; REQUIRE(x == bigint::s<512>(a + v));
+            x = a; x -= v; REQUIRE(x == bigint::s<512>(a - v));
+            x = a; x *= (uint32_t)v; REQUIRE(x == bigint::s<512>(a * bigint::s<32>((uint32_t)v)));
+            x = a; x |= (uint16_t)v; REQUIRE(x == bigint::s<512>(a | (uint16_t)v));
+
+            x = a; x += x; REQUIRE(x == bigint::s<512>(a + a));
+            x = a; x *= x; REQUIRE(x == bigint::s<512>(a * a));
+            x = a; x -= x; REQUIRE(x.is_zero());
+        }
+    }
+
+    SECTION( "products past the Karatsuba crossover" ) {
+        TIMES(5) {
+            bigint::s<4096> a, b;
+            random_s(a, i); random_s(b, i + 1);
+            check(a, b);
+        }
+    }
+
+    SECTION( "shifts in place" ) {
+        TIMES(100) {
+            bigint::s<512> a;
+            random_s(a, i);
+            // whole limb shifts take the memmove path, zero shifts the early out
+            size_t shift = (i % 4 == 0) ? impl_t_bit_sz * (mt32() % 10) : mt32() % 600;
+            bigint::s<512> x = a;
+            x <<= shift;
+            REQUIRE(x == (a << shift));
+            bigint::s<512> y = a >> shift;
+            bool bits_match = true;
+            for(size_t j=0; j<x.real_bit_sz; j++){
+                bits_match &= (x.bit_at(j) == (j >= shift && a.bit_at(j - shift)));
+                bits_match &= (y.bit_at(j) == a.bit_at(j + shift));
+            }
+            REQUIRE(bits_match);
+            bigint::s<1024> wide = a;
+            wide <<= shift;
+            REQUIRE(x.was_truncated() == bigint::s<512>(wide).was_truncated());
+            x = a;
+            x >>= shift;
+            REQUIRE(x == (a >> shift));
+            REQUIRE(!x.was_truncated());
+        }
+    }
+
+    SECTION( "increment and decrement modify their operand" ) {
+        bigint::s<128> x(1);
+        REQUIRE(equal(--x, (uint64_t)0));
+        REQUIRE((x--).is_zero());
+        REQUIRE(x == bigint::s<128>(-1));
+        REQUIRE(x++ == bigint::s<128>(-1));
+        REQUIRE(equal(++x, (uint64_t)1));
+        x = bigint::s<128>(0);
+        for(auto& seg : x._segments) seg = (impl_t)-1;
+        ++x;
+        REQUIRE(x.is_zero());
+        REQUIRE(x.was_truncated());
+    }
+}
+
+TEST_CASE( "Expression templates" ) {
+    auto random_s = [](auto& bint, size_t i){
+        for(auto& seg : bint._segments) seg = (impl_t)mt64();
+        if(i % 7 == 0) for(auto& seg : bint._segments) seg = (impl_t)-1;
+        bint.set_sign(i % 3 == 0);
+    };
+
+    SECTION( "sums, products, shifts and bitwise operations match the eager operators" ) {
+        TIMES(50) {
+            bigint::s<512> a, b, e;
+            bigint::s<256> c, d;
+            random_s(a, i); random_s(b, i + 1); random_s(c, i + 2); random_s(d, i + 3); random_s(e, i + 4);
+            if(i % 5 == 0) d = c;
+
+            auto fused = bigint::eval(bigint::lazy(a)*b + c*d - e);
+            static_assert(std::is_same<decltype(fused), decltype(a*b + c*d - e)>::value);
+            REQUIRE(fused == a*b + c*d - e);
+            REQUIRE(bigint::eval(bigint::lazy(c)*d - c*d).is_zero());
+
+            const size_t l = 37 + i, r = 70 + 3*i;
+            REQUIRE(bigint::eval((bigint::lazy(a) << l) - (b >> r)) == (a << l) - (b >> r));
+            REQUIRE(bigint::eval((bigint::lazy(a) ^ b) + (c | d)*e) == (a ^ b) + (c | d)*e);
+            REQUIRE(bigint::eval((bigint::lazy(a) + c) * (d - e) & b) == (((a + c) * (d - e)) & b));
+
+            bigint::s<256> narrow = bigint::lazy(a)*b - e;
+            REQUIRE(narrow == bigint::s<256>(a*b - e));
+        }
+    }
 
-            // REQUIRE(gmpint_result_bint == bint_result);
+    SECTION( "products above the Karatsuba threshold" ) {
+        TIMES(5) {
+            bigint::s<8192> a, b, c;
+            bigint::s<4096> d;
+            random_s(a, i); random_s(b, i + 1); random_s(c, i + 2); random_s(d, i + 3);
+            REQUIRE(bigint::eval(c - bigint::lazy(a)*b + d*d) == c - a*b + d*d);
         }
     }
 }